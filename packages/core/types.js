@@ -57,12 +57,13 @@ export function createDefaultScoreboard() {
       pointsToWin: 21,
       winBy: 2,
       maxPoints: 30,
-      serveInterval: 2,
+      bestOf: 3,
       firstServe: 'home'
     },
     score: { home: 0, away: 0 },
     serveSide: 'home',
-    history: []
+    // 逐分记录（matchEngine 二进制记录的 Base64），新会话为空
+    record: ''
   }
 }
 
@@ -0,0 +1,62 @@
+/**
+ * Base64 编解码（把二进制记录存入 TEXT/JSON 字段；运行时不保证提供 btoa/atob）
+ */
+
+const ALPHABET = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/'
+
+let lookup = null
+
+function getLookup() {
+  if (lookup) return lookup
+
+  lookup = new Uint8Array(128).fill(255)
+  for (let i = 0; i < ALPHABET.length; i++) {
+    lookup[ALPHABET.charCodeAt(i)] = i
+  }
+  return lookup
+}
+
+/**
+ * 字节编码为 Base64 字符串
+ * @param {Uint8Array} bytes - 字节
+ * @returns {string} Base64（带 = 填充）
+ */
+export function encodeBase64(bytes) {
+  let text = ''
+  for (let i = 0; i < bytes.length; i += 3) {
+    const b0 = bytes[i]
+    const b1 = i + 1 < bytes.length ? bytes[i + 1] : 0
+    const b2 = i + 2 < bytes.length ? bytes[i + 2] : 0
+    text += ALPHABET[b0 >> 2] + ALPHABET[((b0 & 3) << 4) | (b1 >> 4)]
+    text += i + 1 < bytes.length ? ALPHABET[((b1 & 15) << 2) | (b2 >> 6)] : '='
+    text += i + 2 < bytes.length ? ALPHABET[b2 & 63] : '='
+  }
+  return text
+}
+
+/**
+ * Base64 字符串解码为字节
+ * @param {string} text - Base64（可带填充）
+ * @returns {Uint8Array|null} 字节，含非法字符时为 null
+ */
+export function decodeBase64(text) {
+  const str = String(text || '').replace(/=+$/, '')
+  const table = getLookup()
+  const bytes = new Uint8Array(Math.floor(str.length * 3 / 4))
+  let buffer = 0
+  let bits = 0
+  let offset = 0
+
+  for (let i = 0; i < str.length; i++) {
+    const code = str.charCodeAt(i)
+    const value = code < 128 ? table[code] : 255
+    if (value === 255) return null
+    buffer = (buffer << 6) | value
+    bits += 6
+    if (bits >= 8) {
+      bits -= 8
+      bytes[offset++] = (buffer >> bits) & 0xFF
+    }
+  }
+  return bytes
+}
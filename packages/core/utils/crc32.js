@@ -0,0 +1,38 @@
+/**
+ * CRC32（IEEE 802.3）校验
+ */
+
+let table = null
+
+function getTable() {
+  if (table) return table
+
+  table = new Uint32Array(256)
+  for (let i = 0; i < 256; i++) {
+    let c = i
+    for (let k = 0; k < 8; k++) {
+      c = c & 1 ? 0xEDB88320 ^ (c >>> 1) : c >>> 1
+    }
+    table[i] = c >>> 0
+  }
+  return table
+}
+
+/**
+ * 计算字节区间的 CRC32，可传入上一段的结果继续累加
+ * @param {Uint8Array} bytes - 字节
+ * @param {number} start - 起始下标（含）
+ * @param {number} end - 结束下标（不含）
+ * @param {number} previous - 上一段的 CRC32，首段传 0
+ * @returns {number} CRC32（无符号）
+ */
+export function crc32(bytes, start = 0, end = bytes.length, previous = 0) {
+  const lookup = getTable()
+  let crc = (previous ^ 0xFFFFFFFF) >>> 0
+
+  for (let i = start; i < end; i++) {
+    crc = lookup[(crc ^ bytes[i]) & 0xFF] ^ (crc >>> 8)
+  }
+
+  return (crc ^ 0xFFFFFFFF) >>> 0
+}
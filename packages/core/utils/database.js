@@ -36,8 +36,96 @@ const ALTER_TABLE_SCOREBOARD = `ALTER TABLE sessions ADD COLUMN scoreboard TEXT`
 const ALTER_TABLE_HEART_RATE_WARNING_EVENTS = `ALTER TABLE sessions ADD COLUMN heart_rate_warning_events TEXT`
 const ALTER_TABLE_UPDATED_AT = `ALTER TABLE sessions ADD COLUMN updated_at INTEGER`
 
+// 引入 user_version 之前的旧库可能缺失的列及补列语句，按声明顺序执行
+const SESSION_COLUMN_PATCHES = [
+  { column: 'heart_rate_series', sql: ALTER_TABLE_HEART_RATE_SERIES },
+  { column: 'speed_series', sql: ALTER_TABLE_SPEED_SERIES },
+  { column: 'scoreboard', sql: ALTER_TABLE_SCOREBOARD },
+  { column: 'heart_rate_warning_events', sql: ALTER_TABLE_HEART_RATE_WARNING_EVENTS },
+  { column: 'updated_at', sql: ALTER_TABLE_UPDATED_AT }
+]
+
+// WAL 让读写互不阻塞且设置持久保存在库文件中，只需在迁移时设置一次
+const JOURNAL_MODE_SQL = 'PRAGMA journal_mode = WAL'
+// 增量回收须在建表前设置，只对新库生效；旧库释放的页留在空闲链表中供后续写入复用
+const AUTO_VACUUM_SQL = 'PRAGMA auto_vacuum = INCREMENTAL'
+// 同步级别是连接级设置，每次打开都要设置；NORMAL 在 WAL 下仍保证崩溃一致性
+const SYNCHRONOUS_SQL = 'PRAGMA synchronous = NORMAL'
+
 const CREATE_INDEX_SQL = `CREATE INDEX IF NOT EXISTS idx_sessions_start_time ON sessions(start_time)`
 
+// 序列分辨率（0 为原始采样，否则为降采样桶宽毫秒），供数据保留任务按年龄挑选会话
+const ALTER_TABLE_SERIES_RESOLUTION = `ALTER TABLE sessions ADD COLUMN series_resolution INTEGER DEFAULT 0`
+const CREATE_RETENTION_INDEX_SQL = `CREATE INDEX IF NOT EXISTS idx_sessions_retention ON sessions(series_resolution, start_time)`
+
+// 历史筛选索引：按模式筛选走 mode 前缀（显式带 id，保证 start_time 相同时按 id 排序无需临时排序）；
+// 只按强度阈值筛选时走时间前缀的覆盖索引，计数不回表
+const CREATE_MODE_INDEX_SQL = `
+  CREATE INDEX IF NOT EXISTS idx_sessions_mode_start
+  ON sessions(mode, start_time, id, duration, strokes, calories)
+`
+const CREATE_EFFORT_INDEX_SQL = `
+  CREATE INDEX IF NOT EXISTS idx_sessions_effort
+  ON sessions(start_time, duration, strokes, calories, mode)
+`
+
+// 逐拍明细：按 (会话, 时间) 聚簇存储，时间范围读取直接走主键
+const CREATE_STROKES_TABLE_SQL = `
+  CREATE TABLE IF NOT EXISTS session_strokes (
+    session_id INTEGER NOT NULL,
+    t INTEGER NOT NULL,
+    type INTEGER NOT NULL,
+    speed REAL,
+    peak_acc REAL,
+    rally INTEGER,
+    PRIMARY KEY (session_id, t)
+  ) WITHOUT ROWID
+`
+
+// 分布直方图：每个会话按 (指标, 箱) 存计数，周期汇总按同样的箱合并计数；
+// histogram_version 标记会话直方图所用的分箱版本，供后台任务回填旧会话
+const ALTER_TABLE_HISTOGRAM_VERSION = `ALTER TABLE sessions ADD COLUMN histogram_version INTEGER DEFAULT 0`
+const CREATE_HISTOGRAM_INDEX_SQL = `CREATE INDEX IF NOT EXISTS idx_sessions_histogram ON sessions(histogram_version)`
+const CREATE_SESSION_HISTOGRAMS_TABLE_SQL = `
+  CREATE TABLE IF NOT EXISTS session_histograms (
+    session_id INTEGER NOT NULL,
+    metric TEXT NOT NULL,
+    bin INTEGER NOT NULL,
+    count INTEGER NOT NULL,
+    PRIMARY KEY (session_id, metric, bin)
+  ) WITHOUT ROWID
+`
+const CREATE_ROLLUP_HISTOGRAMS_TABLE_SQL = `
+  CREATE TABLE IF NOT EXISTS rollup_histograms (
+    period TEXT NOT NULL,
+    metric TEXT NOT NULL,
+    period_start INTEGER NOT NULL,
+    bin INTEGER NOT NULL,
+    count INTEGER NOT NULL,
+    PRIMARY KEY (period, metric, period_start, bin)
+  ) WITHOUT ROWID
+`
+
+// 个人最佳：每个指标只保留前几名（值相同按会话先后），随会话写入在同一事务内维护
+const CREATE_PERSONAL_BESTS_TABLE_SQL = `
+  CREATE TABLE IF NOT EXISTS personal_bests (
+    metric TEXT NOT NULL,
+    session_id INTEGER NOT NULL,
+    value REAL NOT NULL,
+    start_time INTEGER,
+    PRIMARY KEY (metric, session_id)
+  ) WITHOUT ROWID
+`
+
+// 成就状态：每条规则一行，累计类为累计值，单场类为单场最好成绩
+const CREATE_ACHIEVEMENTS_TABLE_SQL = `
+  CREATE TABLE IF NOT EXISTS achievements (
+    id TEXT PRIMARY KEY,
+    progress REAL DEFAULT 0,
+    unlocked_at INTEGER
+  )
+`
+
 const CREATE_SETTINGS_TABLE_SQL = `
   CREATE TABLE IF NOT EXISTS user_settings (
     id INTEGER PRIMARY KEY CHECK (id = 1),
@@ -46,53 +134,172 @@ const CREATE_SETTINGS_TABLE_SQL = `
   )
 `
 
-let initPromise = null
-
-function ensureSessionColumns() {
-  const hasTableSql = `SELECT name FROM sqlite_master WHERE type='table' AND name='sessions'`
+const CREATE_CHECKPOINTS_TABLE_SQL = `
+  CREATE TABLE IF NOT EXISTS session_checkpoints (
+    seq INTEGER PRIMARY KEY AUTOINCREMENT,
+    session_key INTEGER NOT NULL,
+    kind TEXT NOT NULL,
+    t INTEGER,
+    v REAL,
+    payload TEXT
+  )
+`
 
-  return executeSqlInternal(hasTableSql)
-    .then(result => {
-      if (!result || !result.rows || result.rows.length === 0) {
-        return false
-      }
+const CREATE_CHECKPOINTS_INDEX_SQL = `CREATE INDEX IF NOT EXISTS idx_checkpoints_session ON session_checkpoints(session_key, kind)`
 
-      return executeSqlInternal('PRAGMA table_info(sessions)')
-    })
-    .then(info => {
-      if (!info || !info.rows || info.rows.length === 0) {
-        return false
-      }
+const CREATE_ROLLUPS_TABLE_SQL = `
+  CREATE TABLE IF NOT EXISTS session_rollups (
+    period TEXT NOT NULL,
+    period_start INTEGER NOT NULL,
+    session_count INTEGER DEFAULT 0,
+    total_duration INTEGER DEFAULT 0,
+    total_calories REAL DEFAULT 0,
+    total_strokes INTEGER DEFAULT 0,
+    total_smashes INTEGER DEFAULT 0,
+    heart_rate_weighted REAL DEFAULT 0,
+    max_speed_sum REAL DEFAULT 0,
+    PRIMARY KEY (period, period_start)
+  )
+`
 
-      const columns = info.rows.map(row => row.name)
-      const tasks = []
+// 疲劳检测结果（packages/motion/fatigue），随会话保存
+const ALTER_TABLE_FATIGUE_LEVEL = `ALTER TABLE sessions ADD COLUMN fatigue_level INTEGER DEFAULT 0`
+const ALTER_TABLE_FATIGUE_SCORE = `ALTER TABLE sessions ADD COLUMN fatigue_score REAL DEFAULT 0`
 
-      if (!columns.includes('heart_rate_series')) {
-        tasks.push(executeSqlInternal(ALTER_TABLE_HEART_RATE_SERIES))
-      }
+/**
+ * 数据库迁移列表，按 version 递增排列
+ * 每个迁移在独立事务内执行，并在同一事务内写入 PRAGMA user_version；
+ * 新增表或列时在末尾追加一项，不要修改已发布的迁移
+ */
+const MIGRATIONS = [
+  {
+    version: 1,
+    // 基础表结构；兼容引入 user_version 之前的旧库（补齐缺失列）
+    up: tx => runStatements(tx, [
+      { sql: CREATE_TABLE_SQL },
+      { sql: CREATE_INDEX_SQL },
+      { sql: CREATE_SETTINGS_TABLE_SQL }
+    ]).then(() => patchSessionColumns(tx))
+  },
+  {
+    version: 2,
+    // 周期统计汇总表，已有会话由 service/rollups 的一致性检查回填
+    up: tx => tx.executeSql({ sql: CREATE_ROLLUPS_TABLE_SQL })
+  },
+  {
+    version: 3,
+    // 运动中的追加式检查点日志，用于崩溃后恢复未结束的会话
+    up: tx => runStatements(tx, [
+      { sql: CREATE_CHECKPOINTS_TABLE_SQL },
+      { sql: CREATE_CHECKPOINTS_INDEX_SQL }
+    ])
+  },
+  {
+    version: 4,
+    // 序列分层降采样（service/retention）
+    up: tx => runStatements(tx, [
+      { sql: ALTER_TABLE_SERIES_RESOLUTION },
+      { sql: CREATE_RETENTION_INDEX_SQL }
+    ])
+  },
+  {
+    version: 5,
+    // 历史记录按模式/日期/强度筛选
+    up: tx => runStatements(tx, [
+      { sql: CREATE_MODE_INDEX_SQL },
+      { sql: CREATE_EFFORT_INDEX_SQL }
+    ])
+  },
+  {
+    version: 6,
+    // 逐拍明细，供报告回放
+    up: tx => tx.executeSql({ sql: CREATE_STROKES_TABLE_SQL })
+  },
+  {
+    version: 7,
+    // 拍速/心率分布直方图，旧会话由 service/histograms 后台回填
+    up: tx => runStatements(tx, [
+      { sql: ALTER_TABLE_HISTOGRAM_VERSION },
+      { sql: CREATE_HISTOGRAM_INDEX_SQL },
+      { sql: CREATE_SESSION_HISTOGRAMS_TABLE_SQL },
+      { sql: CREATE_ROLLUP_HISTOGRAMS_TABLE_SQL }
+    ])
+  },
+  {
+    version: 8,
+    // 个人最佳索引，已有会话由 service/personalBests 首次读取时回填
+    up: tx => tx.executeSql({ sql: CREATE_PERSONAL_BESTS_TABLE_SQL })
+  },
+  {
+    version: 9,
+    // 成就状态，由 service/achievements 随事件与会话入库维护
+    up: tx => tx.executeSql({ sql: CREATE_ACHIEVEMENTS_TABLE_SQL })
+  },
+  {
+    version: 10,
+    // 会话疲劳等级与疲劳分
+    up: tx => runStatements(tx, [
+      { sql: ALTER_TABLE_FATIGUE_LEVEL },
+      { sql: ALTER_TABLE_FATIGUE_SCORE }
+    ])
+  }
+]
 
-      if (!columns.includes('speed_series')) {
-        tasks.push(executeSqlInternal(ALTER_TABLE_SPEED_SERIES))
-      }
+const SCHEMA_VERSION = MIGRATIONS[MIGRATIONS.length - 1].version
 
-      if (!columns.includes('scoreboard')) {
-        tasks.push(executeSqlInternal(ALTER_TABLE_SCOREBOARD))
-      }
+let initPromise = null
+let writeQueue = Promise.resolve()
 
-      if (!columns.includes('heart_rate_warning_events')) {
-        tasks.push(executeSqlInternal(ALTER_TABLE_HEART_RATE_WARNING_EVENTS))
-      }
+function patchSessionColumns(tx) {
+  return tx.executeSql({ sql: 'PRAGMA table_info(sessions)' })
+    .then(info => {
+      const columns = (info && info.rows ? info.rows : []).map(row => row.name)
+      const statements = SESSION_COLUMN_PATCHES
+        .filter(patch => !columns.includes(patch.column))
+        .map(patch => ({ sql: patch.sql }))
 
-      if (!columns.includes('updated_at')) {
-        tasks.push(executeSqlInternal(ALTER_TABLE_UPDATED_AT))
-      }
+      return runStatements(tx, statements)
+    })
+}
 
-      if (!tasks.length) return true
-      return Promise.all(tasks).then(() => true)
+function readSchemaVersion() {
+  return executeSqlInternal('PRAGMA user_version')
+    .then(data => {
+      const row = data && data.rows && data.rows[0]
+      return row ? Number(row.user_version) || 0 : 0
     })
-    .catch(err => {
-      console.error('Ensure session columns failed:', err)
-      return false
+}
+
+/**
+ * 执行未应用的迁移；已是最新版本时只有一次 PRAGMA 读取
+ * @returns {Promise<number>} 迁移后的版本号
+ */
+function migrate() {
+  return readSchemaVersion()
+    .then(current => {
+      const pending = MIGRATIONS.filter(migration => migration.version > current)
+      if (!pending.length) return current
+
+      console.log(`数据库迁移: v${current} -> v${SCHEMA_VERSION}`)
+
+      const prepare = current === 0
+        ? executeSqlInternal(AUTO_VACUUM_SQL).catch(() => null)
+        : Promise.resolve()
+
+      return prepare
+        .then(() => executeSqlInternal(JOURNAL_MODE_SQL))
+        .catch(err => {
+          // 平台不支持时退回默认日志模式，不影响使用
+          console.error('Set journal mode failed:', err)
+        })
+        .then(() => pending.reduce(
+          (chain, migration) => chain.then(() => runTransaction(tx => {
+            return migration.up(tx)
+              .then(() => tx.executeSql({ sql: `PRAGMA user_version = ${migration.version}` }))
+          })),
+          Promise.resolve()
+        ))
+        .then(() => SCHEMA_VERSION)
     })
 }
 
@@ -139,12 +346,15 @@ function executeSqlInternal(sql, args = []) {
 function init() {
   if (initPromise) return initPromise
 
+  const startedAt = Date.now()
+
   initPromise = openDatabase()
-    .then(() => executeSqlInternal(CREATE_TABLE_SQL))
-    .then(() => executeSqlInternal(CREATE_INDEX_SQL))
-    .then(() => executeSqlInternal(CREATE_SETTINGS_TABLE_SQL))
-    .then(() => ensureSessionColumns())
-    .then(() => true)
+    .then(() => executeSqlInternal(SYNCHRONOUS_SQL).catch(() => null))
+    .then(() => migrate())
+    .then(version => {
+      console.log(`数据库就绪: schema v${version}, 耗时 ${Date.now() - startedAt}ms`)
+      return true
+    })
     .catch(err => {
       console.error('Database init failed:', err)
       return false
@@ -161,7 +371,73 @@ function executeSql({ sql, args = [] }) {
   return initPromise.then(() => executeSqlInternal(sql, args))
 }
 
+function runStatements(tx, statements) {
+  return statements.reduce(
+    (chain, statement) => chain.then(() => tx.executeSql(statement)),
+    Promise.resolve()
+  )
+}
+
+function runTransaction(work) {
+  const committedCallbacks = []
+  const rolledBackCallbacks = []
+  const tx = {
+    executeSql: ({ sql, args = [] }) => executeSqlInternal(sql, args),
+    // 登记提交成功后才执行的副作用（如写文件），回滚时丢弃
+    afterCommit: callback => committedCallbacks.push(callback),
+    // 登记回滚后执行的清理（如丢弃事务期间读入缓存的未提交数据），提交时丢弃
+    afterRollback: callback => rolledBackCallbacks.push(callback)
+  }
+
+  return executeSqlInternal('BEGIN IMMEDIATE')
+    .then(() => work(tx))
+    .then(result => executeSqlInternal('COMMIT')
+      .then(() => Promise.all(committedCallbacks.map(callback => Promise.resolve()
+        .then(callback)
+        .catch(err => console.error('After commit callback failed:', err)))))
+      .then(() => result))
+    .catch(err => executeSqlInternal('ROLLBACK')
+      .catch(() => null)
+      .then(() => {
+        rolledBackCallbacks.forEach(callback => {
+          try {
+            callback()
+          } catch (e) {
+            console.error('After rollback callback failed:', e)
+          }
+        })
+        throw err
+      }))
+}
+
+/**
+ * 在单个事务内执行一组写操作，任一步失败则整体回滚
+ * 事务之间串行排队，避免 BEGIN 嵌套
+ * @param {Function} work - 接收 tx（tx.executeSql 与 executeSql 同签名，tx.afterCommit / tx.afterRollback 登记提交后 / 回滚后回调）并返回 Promise
+ * @returns {Promise} work 的结果
+ */
+function transaction(work) {
+  if (!initPromise) {
+    initPromise = init()
+  }
+
+  const task = writeQueue.then(() => initPromise).then(() => runTransaction(work))
+  writeQueue = task.catch(() => null)
+  return task
+}
+
+/**
+ * 在一个事务内按顺序执行多条语句
+ * @param {Array<{sql:string,args:Array}>} statements - 语句列表
+ * @returns {Promise} 全部执行完成
+ */
+function batch(statements) {
+  return transaction(tx => runStatements(tx, statements))
+}
+
 export default {
   init,
-  executeSql
+  executeSql,
+  transaction,
+  batch
 }
@@ -0,0 +1,252 @@
+/**
+ * 序列降采样工具
+ */
+
+function round2(value) {
+  return Math.round(value * 100) / 100
+}
+
+/**
+ * 按固定时间桶聚合序列，每桶保留 平均/最小/最大 与点数
+ * 输入可以是原始点 {t, v}，也可以是已聚合的点 {t, v, min, max, n}（按点数加权合并）
+ * @param {Array<{t:number,v:number,min?:number,max?:number,n?:number}>} series - 按时间升序的序列
+ * @param {number} bucketMs - 桶宽（毫秒）
+ * @returns {Array<{t:number,v:number,min:number,max:number,n:number}>} 聚合后的序列，t 为桶起点
+ */
+export function bucketSeries(series, bucketMs) {
+  if (!Array.isArray(series) || !series.length || !(bucketMs > 0)) return series || []
+
+  const result = []
+  let bucket = null
+
+  const flush = () => {
+    if (!bucket) return
+    result.push({
+      t: bucket.t,
+      v: round2(bucket.sum / bucket.n),
+      min: bucket.min,
+      max: bucket.max,
+      n: bucket.n
+    })
+  }
+
+  series.forEach(point => {
+    if (!point || typeof point.t !== 'number') return
+
+    const value = Number(point.v) || 0
+    const count = point.n || 1
+    const start = Math.floor(point.t / bucketMs) * bucketMs
+
+    if (!bucket || bucket.t !== start) {
+      flush()
+      bucket = { t: start, sum: 0, n: 0, min: Infinity, max: -Infinity }
+    }
+
+    bucket.sum += value * count
+    bucket.n += count
+    bucket.min = Math.min(bucket.min, point.min !== undefined ? point.min : value)
+    bucket.max = Math.max(bucket.max, point.max !== undefined ? point.max : value)
+  })
+
+  flush()
+  return result
+}
+
+/**
+ * 点数组转为绘图用的列式序列；时间偏移用 Float64，跨度超过 Uint32 毫秒（约 49 天）的年度汇总也不溢出
+ * @param {Array<{t:number,v:number}>} points - 按时间升序的点
+ * @returns {{baseTime:number,t:Float64Array,v:Float32Array,length:number}} 列式序列
+ */
+export function columnarFromPoints(points) {
+  const list = Array.isArray(points) ? points : []
+  const baseTime = list.length ? list[0].t : 0
+  const t = new Float64Array(list.length)
+  const v = new Float32Array(list.length)
+
+  for (let i = 0; i < list.length; i++) {
+    t[i] = list[i].t - baseTime
+    v[i] = Number(list[i].v) || 0
+  }
+
+  return { baseTime, t, v, length: list.length }
+}
+
+/**
+ * 列式序列的时间与数值范围，一次遍历
+ * @param {{baseTime:number,t:ArrayLike<number>,v:ArrayLike<number>,length:number}} series - 列式序列
+ * @returns {{tMin:number,tMax:number,vMin:number,vMax:number}} 范围（绝对时间戳），空序列为 ±Infinity
+ */
+export function seriesExtent(series) {
+  let tMin = Infinity
+  let tMax = -Infinity
+  let vMin = Infinity
+  let vMax = -Infinity
+  const length = series ? series.length : 0
+
+  if (length) {
+    // 时间升序，首尾即时间范围
+    tMin = series.baseTime + series.t[0]
+    tMax = series.baseTime + series.t[length - 1]
+  }
+  for (let i = 0; i < length; i++) {
+    const v = series.v[i]
+    if (v < vMin) vMin = v
+    if (v > vMax) vMax = v
+  }
+
+  return { tMin, tMax, vMin, vMax }
+}
+
+// M4 分组宽度（像素）：每 2 列一组，输出点数不超过绘图区宽度的 2 倍
+const M4_GROUP_WIDTH = 2
+
+/**
+ * M4 降采样：按像素分组（每组 M4_GROUP_WIDTH 列）保留 首/最小/最大/末 四个点（最小、最大按时间先后），
+ * 折线画出的每组竖向跨度与原始序列一致，点坐标不取整，输出点数不超过 2 × 绘图区宽度
+ * @param {{baseTime:number,t:ArrayLike<number>,v:ArrayLike<number>,length:number}} series - 按时间升序的列式序列
+ * @param {{left:number,top:number,width:number,height:number,tMin:number,tMax:number,vMin:number,vMax:number}} layout - 绘图区（像素）与坐标范围
+ * @param {{xy:Float32Array,count:number}} out - 可选的输出缓冲，容量足够时原地写入，重复绘制不再分配
+ * @returns {{xy:Float32Array,count:number}} 可直接绘制的像素坐标 [x0, y0, x1, y1, ...] 与点数
+ */
+export function m4Columnar(series, layout, out) {
+  const length = series ? series.length : 0
+  const columns = Math.max(1, Math.floor(layout.width / M4_GROUP_WIDTH))
+  const capacity = Math.min(length, columns * 4) * 2
+  const result = out || { xy: null, count: 0 }
+  const xy = result.xy && result.xy.length >= capacity ? result.xy : new Float32Array(capacity)
+  result.xy = xy
+  result.count = 0
+  if (!length) return result
+
+  const scaleX = layout.width / (layout.tMax - layout.tMin || 1)
+  const scaleColumn = columns / (layout.tMax - layout.tMin || 1)
+  const scaleY = layout.height / (layout.vMax - layout.vMin || 1)
+  const bottom = layout.top + layout.height
+  const offset = series.baseTime - layout.tMin
+  const t = series.t
+  const v = series.v
+  let count = 0
+
+  const emit = index => {
+    xy[count * 2] = layout.left + (t[index] + offset) * scaleX
+    xy[count * 2 + 1] = bottom - (v[index] - layout.vMin) * scaleY
+    count++
+  }
+
+  let column = -1
+  let first = 0
+  let min = 0
+  let max = 0
+  let last = 0
+
+  const flush = () => {
+    emit(first)
+    const low = min < max ? min : max
+    const high = min < max ? max : min
+    if (low !== first) emit(low)
+    if (high !== low && high !== first) emit(high)
+    if (last !== high && last !== low && last !== first) emit(last)
+  }
+
+  for (let i = 0; i < length; i++) {
+    const col = Math.min(columns - 1, Math.max(0, Math.floor((t[i] + offset) * scaleColumn)))
+    if (col !== column) {
+      if (column >= 0) flush()
+      column = col
+      first = min = max = last = i
+      continue
+    }
+    if (v[i] < v[min]) min = i
+    if (v[i] > v[max]) max = i
+    last = i
+  }
+  flush()
+
+  result.count = count
+  return result
+}
+
+// 折线图每像素最多输入的点数
+export const CHART_POINTS_PER_PIXEL = 2
+
+/**
+ * 画布宽度对应的折线点数上限
+ * @param {number} width - 画布宽度（像素）
+ * @returns {number} 点数上限
+ */
+export function chartPointLimit(width) {
+  return Math.max(3, Math.floor((width || 0) * CHART_POINTS_PER_PIXEL))
+}
+
+/**
+ * Largest-Triangle-Three-Buckets 选点：保留首尾点，其余按等分桶各取一个与相邻选点构成最大三角形的点，
+ * 在点数大幅减少时仍保留峰谷形状
+ * @param {ArrayLike<number>} x - 横坐标（升序）
+ * @param {ArrayLike<number>} y - 纵坐标
+ * @param {number} length - 点数
+ * @param {number} threshold - 目标点数
+ * @returns {Uint32Array|null} 选中点的下标；无需降采样时为 null
+ */
+export function lttbIndices(x, y, length, threshold) {
+  if (!(threshold >= 3) || length <= threshold) return null
+
+  const indices = new Uint32Array(threshold)
+  const bucketSize = (length - 2) / (threshold - 2)
+  let selected = 0
+
+  for (let i = 0; i < threshold - 2; i++) {
+    // 下一个桶的平均点作为三角形的第三个顶点
+    const nextStart = Math.floor((i + 1) * bucketSize) + 1
+    const nextEnd = Math.min(length, Math.floor((i + 2) * bucketSize) + 1)
+    let avgX = 0
+    let avgY = 0
+    for (let j = nextStart; j < nextEnd; j++) {
+      avgX += x[j]
+      avgY += y[j]
+    }
+    const nextCount = nextEnd - nextStart || 1
+    avgX /= nextCount
+    avgY /= nextCount
+
+    const start = Math.floor(i * bucketSize) + 1
+    const end = Math.floor((i + 1) * bucketSize) + 1
+    const ax = x[selected]
+    const ay = y[selected]
+    let maxArea = -1
+    let pick = start
+
+    for (let j = start; j < end; j++) {
+      const area = Math.abs((ax - avgX) * (y[j] - ay) - (ax - x[j]) * (avgY - ay))
+      if (area > maxArea) {
+        maxArea = area
+        pick = j
+      }
+    }
+
+    indices[i + 1] = pick
+    selected = pick
+  }
+
+  indices[threshold - 1] = length - 1
+  return indices
+}
+
+/**
+ * 点数组 LTTB 降采样（周期统计趋势在缓存前预降采样）
+ * @param {Array<{t:number,v:number}>} points - 按时间升序的点
+ * @param {number} threshold - 目标点数
+ * @returns {Array<{t:number,v:number}>} 降采样后的点，未超出时原样返回
+ */
+export function lttbPoints(points, threshold) {
+  if (!Array.isArray(points) || points.length <= threshold) return points || []
+
+  const x = new Float64Array(points.length)
+  const y = new Float64Array(points.length)
+  for (let i = 0; i < points.length; i++) {
+    x[i] = points[i].t
+    y[i] = Number(points[i].v) || 0
+  }
+
+  const indices = lttbIndices(x, y, points.length, threshold)
+  return indices ? Array.from(indices, index => points[index]) : points
+}
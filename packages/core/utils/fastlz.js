@@ -0,0 +1,129 @@
+/**
+ * FastLZ（level 1）压缩/解压
+ *
+ * 指令流：
+ *   字面量  000LLLLL + (L+1) 个原样字节（L+1 ≤ 32）
+ *   短匹配  LLLDDDDD DDDDDDDD            长度 = LLL + 2（LLL 为 1..6）
+ *   长匹配  111DDDDD EEEEEEEE DDDDDDDD   长度 = 7 + E + 2
+ * 距离 = D + 1（≤ 8192），匹配长度 3..264；首个指令必为字面量（高 3 位为压缩级别 0）。
+ */
+
+const MAX_LITERAL = 32
+const MAX_DISTANCE = 8191
+const MAX_LENGTH = 264
+const HASH_LOG = 13
+const HASH_SIZE = 1 << HASH_LOG
+
+function hash(bytes, i) {
+  const v = bytes[i] | (bytes[i + 1] << 8) | (bytes[i + 2] << 16)
+  return ((v * 2654435761) >>> (32 - HASH_LOG)) & (HASH_SIZE - 1)
+}
+
+/**
+ * 压缩
+ * @param {Uint8Array} input - 原始字节
+ * @returns {Uint8Array} 压缩后的字节
+ */
+export function compress(input) {
+  const length = input.length
+  // 最坏情况：全部为字面量，每 32 字节多 1 个指令字节
+  const output = new Uint8Array(length + Math.ceil(length / MAX_LITERAL) + 1)
+  const table = new Int32Array(HASH_SIZE).fill(-1)
+
+  let op = 0
+  let anchor = 0
+  let ip = 0
+
+  const emitLiterals = end => {
+    while (anchor < end) {
+      const run = Math.min(MAX_LITERAL, end - anchor)
+      output[op++] = run - 1
+      output.set(input.subarray(anchor, anchor + run), op)
+      op += run
+      anchor += run
+    }
+  }
+
+  // 至少保留 3 字节才可能匹配
+  while (ip + 2 < length) {
+    const h = hash(input, ip)
+    const ref = table[h]
+    table[h] = ip
+
+    const distance = ip - ref - 1
+    if (ref < 0 || distance > MAX_DISTANCE ||
+        input[ref] !== input[ip] || input[ref + 1] !== input[ip + 1] || input[ref + 2] !== input[ip + 2]) {
+      ip++
+      continue
+    }
+
+    let matchLength = 3
+    const limit = Math.min(MAX_LENGTH, length - ip)
+    while (matchLength < limit && input[ref + matchLength] === input[ip + matchLength]) {
+      matchLength++
+    }
+
+    emitLiterals(ip)
+
+    const code = matchLength - 2
+    if (code < 7) {
+      output[op++] = (code << 5) | (distance >> 8)
+    } else {
+      output[op++] = (7 << 5) | (distance >> 8)
+      output[op++] = code - 7
+    }
+    output[op++] = distance & 0xFF
+
+    ip += matchLength
+    anchor = ip
+  }
+
+  emitLiterals(length)
+  return output.subarray(0, op)
+}
+
+/**
+ * 解压
+ * @param {Uint8Array} input - 压缩字节
+ * @param {number} outputLength - 原始长度（已知时传入以免扩容）
+ * @returns {Uint8Array} 原始字节
+ */
+export function decompress(input, outputLength = 0) {
+  let output = new Uint8Array(outputLength || input.length * 2 + 64)
+  let op = 0
+  let ip = 0
+
+  const ensure = extra => {
+    if (op + extra <= output.length) return
+    const next = new Uint8Array(Math.max(output.length * 2, op + extra))
+    next.set(output.subarray(0, op))
+    output = next
+  }
+
+  while (ip < input.length) {
+    const ctrl = ip === 0 ? input[ip++] & 31 : input[ip++]
+
+    if (ctrl < 32) {
+      const run = ctrl + 1
+      if (ip + run > input.length) throw new Error('fastlz: 字面量越界')
+      ensure(run)
+      output.set(input.subarray(ip, ip + run), op)
+      op += run
+      ip += run
+      continue
+    }
+
+    let matchLength = (ctrl >> 5) + 2
+    if (matchLength === 9) matchLength += input[ip++]
+    const ref = op - ((ctrl & 31) << 8) - input[ip++] - 1
+    if (ref < 0 || ip > input.length) throw new Error('fastlz: 匹配越界')
+
+    ensure(matchLength)
+    for (let i = 0; i < matchLength; i++) {
+      output[op + i] = output[ref + i]
+    }
+    op += matchLength
+  }
+
+  return output.subarray(0, op)
+}
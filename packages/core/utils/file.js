@@ -0,0 +1,116 @@
+/**
+ * 文件读写工具（@blueos.storage.file 的 Promise 封装）
+ */
+
+// 应用私有文件目录
+export const FILES_DIR = 'internal://files/'
+
+function getFileApi() {
+  return global.file || null
+}
+
+function call(method, options) {
+  return new Promise((resolve, reject) => {
+    const api = getFileApi()
+    const fn = api && api[method]
+    if (typeof fn !== 'function') {
+      reject(new Error(`file.${method} 不可用`))
+      return
+    }
+
+    try {
+      fn.call(api, {
+        ...options,
+        success: (data) => resolve(data),
+        fail: (data, code) => reject(new Error(`file.${method} failed: ${code}`))
+      })
+    } catch (e) {
+      reject(e)
+    }
+  })
+}
+
+/**
+ * 读取文件字节
+ * @param {string} uri - 文件 uri
+ * @param {number} position - 起始位置
+ * @param {number} length - 读取长度，不传则读到文件末尾
+ * @returns {Promise<Uint8Array>} 文件字节
+ */
+export function readBytes(uri, position = 0, length) {
+  const options = { uri, position }
+  if (length !== undefined) options.length = length
+
+  return call('readArrayBuffer', options)
+    .then(data => (data && data.buffer) || new Uint8Array(0))
+}
+
+/**
+ * 写入文件字节
+ * @param {string} uri - 文件 uri
+ * @param {Uint8Array} buffer - 写入内容
+ * @param {{position?:number,append?:boolean}} options - 写入位置或追加模式
+ * @returns {Promise}
+ */
+export function writeBytes(uri, buffer, options = {}) {
+  return call('writeArrayBuffer', { uri, buffer, ...options })
+}
+
+/**
+ * 获取文件信息，文件不存在时返回 null
+ * @param {string} uri - 文件 uri
+ * @returns {Promise<Object|null>} 文件信息
+ */
+export function statFile(uri) {
+  return call('get', { uri }).catch(() => null)
+}
+
+/**
+ * 列出目录下的文件
+ * @param {string} uri - 目录 uri
+ * @returns {Promise<Array>} 文件列表
+ */
+export function listFiles(uri) {
+  return call('list', { uri })
+    .then(data => (data && data.fileList) || [])
+    .catch(() => [])
+}
+
+/**
+ * 删除文件，文件不存在视为成功
+ * @param {string} uri - 文件 uri
+ * @returns {Promise}
+ */
+export function removeFile(uri) {
+  const api = getFileApi()
+  const method = api && typeof api.delete === 'function' ? 'delete' : 'del'
+  return call(method, { uri }).catch(() => null)
+}
+
+/**
+ * 移动文件（同目录内即重命名），目标已存在时覆盖
+ * @param {string} srcUri - 源文件 uri
+ * @param {string} dstUri - 目标文件 uri
+ * @returns {Promise}
+ */
+export function moveFile(srcUri, dstUri) {
+  return call('move', { srcUri, dstUri })
+}
+
+/**
+ * 创建目录（含上级目录），已存在视为成功
+ * @param {string} uri - 目录 uri
+ * @returns {Promise}
+ */
+export function ensureDir(uri) {
+  return call('mkdir', { uri, recursive: true }).catch(() => null)
+}
+
+/**
+ * 删除目录及其内容
+ * @param {string} uri - 目录 uri
+ * @returns {Promise}
+ */
+export function removeDir(uri) {
+  return call('rmdir', { uri, recursive: true }).catch(() => null)
+}
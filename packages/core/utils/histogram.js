@@ -0,0 +1,82 @@
+/**
+ * 定宽分箱直方图
+ * 同一指标的分箱固定，直方图按箱计数相加即可合并、相减即可移出，
+ * 周期汇总可随会话增删增量维护；分位数误差不超过半个箱宽
+ */
+
+// 分箱版本，调整分箱时递增，旧会话由后台任务按新分箱重算
+export const HISTOGRAM_VERSION = 1
+
+export const HISTOGRAM_METRIC = {
+  SPEED: 'speed',
+  HEART_RATE: 'heart_rate'
+}
+
+// 箱宽与箱数：拍速每 2km/h 一箱（0~500km/h），心率每 1bpm 一箱（0~250bpm），超出上限计入末箱
+const HISTOGRAM_SPECS = {
+  [HISTOGRAM_METRIC.SPEED]: { width: 2, bins: 250 },
+  [HISTOGRAM_METRIC.HEART_RATE]: { width: 1, bins: 251 }
+}
+
+/**
+ * 数值所在的箱
+ * @param {string} metric - HISTOGRAM_METRIC
+ * @param {number} value - 数值
+ * @returns {number} 箱序号
+ */
+export function binOf(metric, value) {
+  const spec = HISTOGRAM_SPECS[metric]
+  return Math.min(spec.bins - 1, Math.max(0, Math.floor(value / spec.width)))
+}
+
+/**
+ * 由样本构建直方图，非正数与非数值样本忽略
+ * @param {string} metric - HISTOGRAM_METRIC
+ * @param {Array<{v:number,n?:number}>|Array<number>} samples - 样本；已聚合的点按点数 n 计
+ * @returns {Map<number,number>} 箱序号 -> 计数
+ */
+export function buildHistogram(metric, samples) {
+  const histogram = new Map()
+  if (!HISTOGRAM_SPECS[metric] || !Array.isArray(samples)) return histogram
+
+  samples.forEach(sample => {
+    const value = typeof sample === 'number' ? sample : sample && Number(sample.v)
+    if (!(value > 0)) return
+
+    const weight = sample && sample.n > 0 ? sample.n : 1
+    const bin = binOf(metric, value)
+    histogram.set(bin, (histogram.get(bin) || 0) + weight)
+  })
+
+  return histogram
+}
+
+/**
+ * 计算分位数，箱内按线性插值
+ * @param {string} metric - HISTOGRAM_METRIC
+ * @param {Array<{bin:number,count:number}>} rows - 按箱升序的计数
+ * @param {Array<number>} quantiles - 分位点（0~1）
+ * @returns {Array<number>} 与 quantiles 一一对应的数值，无样本时为 0
+ */
+export function histogramQuantiles(metric, rows, quantiles) {
+  const spec = HISTOGRAM_SPECS[metric]
+  const total = (rows || []).reduce((sum, row) => sum + (row.count > 0 ? row.count : 0), 0)
+  if (!spec || !total) return quantiles.map(() => 0)
+
+  return quantiles.map(q => {
+    const target = Math.min(1, Math.max(0, q)) * total
+    let cumulative = 0
+
+    for (let i = 0; i < rows.length; i++) {
+      const count = rows[i].count > 0 ? rows[i].count : 0
+      if (!count) continue
+      if (cumulative + count >= target) {
+        const value = (rows[i].bin + (target - cumulative) / count) * spec.width
+        return Math.round(value * 10) / 10
+      }
+      cumulative += count
+    }
+
+    return rows[rows.length - 1].bin * spec.width + spec.width
+  })
+}
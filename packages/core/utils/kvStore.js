@@ -0,0 +1,291 @@
+/**
+ * 日志结构键值存储
+ *
+ * 每个存储一个追加写的日志文件，文件头 'FSKV' | version u16 | 保留 u16，之后是记录（小端序）：
+ *   crc32 u32 | flags u8（0 写入 / 1 删除）| 保留 u8 | keyLength u16 | valueLength u32 | key | value(JSON)
+ * crc32 覆盖 crc 之后的全部字节。
+ *
+ * 打开时顺序扫描日志重建内存索引，遇到校验失败或不完整的记录即视为尾部损坏并从该处截断；
+ * 写入只追加一条记录，与历史数据量无关；失效数据超过有效数据时在后台压缩（写临时文件后整体替换）。
+ */
+import { FILES_DIR, ensureDir, readBytes, writeBytes, removeFile, moveFile } from './file'
+import { crc32 } from './crc32'
+import { encodeUtf8, decodeUtf8 } from './utf8'
+
+const KV_DIR = `${FILES_DIR}kv/`
+const KV_MAGIC = 0x564B5346 // 'FSKV'
+const KV_VERSION = 1
+const FILE_HEADER_SIZE = 8
+const RECORD_HEADER_SIZE = 12
+
+const FLAG_PUT = 0
+const FLAG_DELETE = 1
+
+// 失效字节达到该值且超过有效字节时触发压缩
+const COMPACT_MIN_DEAD_BYTES = 16 * 1024
+// 压缩延后执行，合并短时间内的连续写入
+const COMPACT_DELAY = 2000
+
+function encodeFileHeader() {
+  const bytes = new Uint8Array(FILE_HEADER_SIZE)
+  const view = new DataView(bytes.buffer)
+  view.setUint32(0, KV_MAGIC, true)
+  view.setUint16(4, KV_VERSION, true)
+  return bytes
+}
+
+function encodeRecord(flags, key, value) {
+  const keyBytes = encodeUtf8(key)
+  const valueBytes = flags === FLAG_PUT ? encodeUtf8(JSON.stringify(value)) : new Uint8Array(0)
+  const bytes = new Uint8Array(RECORD_HEADER_SIZE + keyBytes.length + valueBytes.length)
+  const view = new DataView(bytes.buffer)
+
+  view.setUint8(4, flags)
+  view.setUint16(6, keyBytes.length, true)
+  view.setUint32(8, valueBytes.length, true)
+  bytes.set(keyBytes, RECORD_HEADER_SIZE)
+  bytes.set(valueBytes, RECORD_HEADER_SIZE + keyBytes.length)
+  view.setUint32(0, crc32(bytes, 4), true)
+
+  return bytes
+}
+
+/**
+ * 扫描日志，返回有效记录与有效数据的结束位置
+ * @param {Uint8Array} bytes - 日志内容
+ * @returns {{records:Array<{flags:number,key:string,value:any,offset:number,size:number}>,end:number}|null} 文件头不符时为 null
+ */
+function scanLog(bytes) {
+  if (bytes.length < FILE_HEADER_SIZE) return null
+
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength)
+  if (view.getUint32(0, true) !== KV_MAGIC || view.getUint16(4, true) > KV_VERSION) return null
+
+  const records = []
+  let offset = FILE_HEADER_SIZE
+
+  while (offset + RECORD_HEADER_SIZE <= bytes.length) {
+    const keyLength = view.getUint16(offset + 6, true)
+    const valueLength = view.getUint32(offset + 8, true)
+    const size = RECORD_HEADER_SIZE + keyLength + valueLength
+    if (offset + size > bytes.length) break
+    if (view.getUint32(offset, true) !== crc32(bytes, offset + 4, offset + size)) break
+
+    const keyStart = offset + RECORD_HEADER_SIZE
+    const flags = view.getUint8(offset + 4)
+    let value
+    try {
+      value = flags === FLAG_PUT
+        ? JSON.parse(decodeUtf8(bytes, keyStart + keyLength, keyStart + keyLength + valueLength))
+        : undefined
+    } catch (e) {
+      break
+    }
+
+    records.push({ flags, key: decodeUtf8(bytes, keyStart, keyStart + keyLength), value, offset, size })
+    offset += size
+  }
+
+  return { records, end: offset }
+}
+
+/**
+ * 创建键值存储
+ * @param {string} name - 存储名，对应 internal://files/kv/<name>.log
+ * @returns {Object} 键值存储
+ */
+export function createKvStore(name) {
+  const uri = `${KV_DIR}${name}.log`
+  const compactUri = `${uri}.compact`
+
+  // key -> { offset, size, value }
+  const index = new Map()
+  let appendOffset = 0
+  let liveBytes = 0
+  let deadBytes = 0
+  let openPromise = null
+  let writeQueue = Promise.resolve()
+  let compactTimer = null
+
+  function enqueue(task) {
+    const run = writeQueue.then(task)
+    writeQueue = run.catch(err => console.error(`KV(${name}) 写入失败:`, err))
+    return run
+  }
+
+  function applyRecord(record) {
+    const previous = index.get(record.key)
+    if (previous) {
+      liveBytes -= previous.size
+      deadBytes += previous.size
+    }
+
+    if (record.flags === FLAG_DELETE) {
+      index.delete(record.key)
+      deadBytes += record.size
+    } else {
+      index.set(record.key, { offset: record.offset, size: record.size, value: record.value })
+      liveBytes += record.size
+    }
+  }
+
+  function loadLog(bytes) {
+    const scanned = scanLog(bytes)
+    if (!scanned) return false
+
+    scanned.records.forEach(applyRecord)
+    appendOffset = scanned.end
+
+    if (scanned.end < bytes.length) {
+      // 断电留下的残缺尾部：后续写入从最后一条有效记录之后覆盖，并尽快压缩
+      console.error(`KV(${name}) 日志尾部损坏，丢弃 ${bytes.length - scanned.end} 字节`)
+      deadBytes += COMPACT_MIN_DEAD_BYTES
+      scheduleCompaction(0)
+    }
+    return true
+  }
+
+  function createLog() {
+    appendOffset = FILE_HEADER_SIZE
+    return writeBytes(uri, encodeFileHeader())
+  }
+
+  /**
+   * 打开存储并由日志重建索引，重复调用返回同一个 Promise
+   * @returns {Promise}
+   */
+  function open() {
+    if (openPromise) return openPromise
+
+    const startedAt = Date.now()
+    openPromise = ensureDir(KV_DIR)
+      .then(() => readBytes(uri).catch(() => null))
+      .then(bytes => {
+        if (bytes && loadLog(bytes)) return null
+
+        // 日志缺失或不可用：压缩完成但尚未替换时，临时文件即完整数据
+        return readBytes(compactUri).catch(() => null)
+          .then(compacted => {
+            if (compacted && loadLog(compacted)) return moveFile(compactUri, uri)
+            return createLog()
+          })
+      })
+      .then(() => {
+        console.log(`KV(${name}) 打开: ${index.size} 个键, 耗时 ${Date.now() - startedAt}ms`)
+      })
+      .catch(err => {
+        console.error(`KV(${name}) 打开失败:`, err)
+      })
+
+    return openPromise
+  }
+
+  function append(flags, key, value) {
+    return open().then(() => enqueue(() => {
+      const record = encodeRecord(flags, key, value)
+      const offset = appendOffset
+
+      return writeBytes(uri, record, { position: offset })
+        .then(() => {
+          appendOffset += record.length
+          applyRecord({ flags, key, value, offset, size: record.length })
+          if (deadBytes >= COMPACT_MIN_DEAD_BYTES && deadBytes > liveBytes) {
+            scheduleCompaction(COMPACT_DELAY)
+          }
+        })
+    }))
+  }
+
+  function scheduleCompaction(delay) {
+    if (compactTimer) return
+    compactTimer = setTimeout(() => {
+      compactTimer = null
+      compact()
+    }, delay)
+  }
+
+  /**
+   * 压缩日志：只保留每个键的最新值，写入临时文件后替换原日志
+   * @returns {Promise}
+   */
+  function compact() {
+    return open().then(() => enqueue(() => {
+      const startedAt = Date.now()
+      const before = appendOffset
+      const parts = [encodeFileHeader()]
+      const entries = []
+      let offset = FILE_HEADER_SIZE
+
+      index.forEach((entry, key) => {
+        const record = encodeRecord(FLAG_PUT, key, entry.value)
+        parts.push(record)
+        entries.push([key, { offset, size: record.length, value: entry.value }])
+        offset += record.length
+      })
+
+      const bytes = new Uint8Array(offset)
+      let position = 0
+      parts.forEach(part => {
+        bytes.set(part, position)
+        position += part.length
+      })
+
+      return removeFile(compactUri)
+        .then(() => writeBytes(compactUri, bytes))
+        // 先删旧日志再改名：中途断电时 open 会从完整的临时文件恢复
+        .then(() => removeFile(uri))
+        .then(() => moveFile(compactUri, uri))
+        .then(() => {
+          entries.forEach(([key, entry]) => index.set(key, entry))
+          appendOffset = offset
+          liveBytes = offset - FILE_HEADER_SIZE
+          deadBytes = 0
+          console.log(`KV(${name}) 压缩: ${before} -> ${offset} 字节, 耗时 ${Date.now() - startedAt}ms`)
+        })
+    }))
+  }
+
+  return {
+    open,
+    compact,
+
+    /**
+     * 读取键值（需先 open）
+     * @param {string} key - 键
+     * @param {any} defaultValue - 不存在时的默认值
+     * @returns {any} 值
+     */
+    get(key, defaultValue) {
+      const entry = index.get(key)
+      return entry ? entry.value : defaultValue
+    },
+
+    /**
+     * 写入键值，只追加一条记录
+     * @param {string} key - 键
+     * @param {any} value - 可 JSON 序列化的值
+     * @returns {Promise}
+     */
+    set(key, value) {
+      return append(FLAG_PUT, key, value)
+    },
+
+    /**
+     * 删除键
+     * @param {string} key - 键
+     * @returns {Promise}
+     */
+    remove(key) {
+      return open().then(() => (index.has(key) ? append(FLAG_DELETE, key) : null))
+    },
+
+    /**
+     * 列出指定前缀的键
+     * @param {string} prefix - 键前缀
+     * @returns {Array<string>} 键列表
+     */
+    keys(prefix = '') {
+      return Array.from(index.keys()).filter(key => key.indexOf(prefix) === 0)
+    }
+  }
+}
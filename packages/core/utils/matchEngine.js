@@ -0,0 +1,328 @@
+/**
+ * 羽毛球比赛计分引擎（BWF 规则）
+ * 支持一局或三局两胜、21 分制（20 平后须领先 2 分，30 分封顶）、领先方先到 11 分的局间休息、
+ * 每局结束与决胜局 11 分时交换场地，以及发球/接发球方位（发球方得分为偶数时在右区）；
+ * 每分只记一个字节（得分方与是否结束本局）到定长增长的日志，撤销/重做只回退或重放一分，O(1)；
+ * 序列化时只保存规则与逐分得分方（每分 1 bit），其余状态由重放得到
+ */
+import { encodeBase64, decodeBase64 } from './base64'
+
+export const MATCH_SIDE = {
+  HOME: 'home',
+  AWAY: 'away'
+}
+
+// 发球/接发球区（站位方自身视角）
+export const MATCH_COURT = {
+  RIGHT: 'right',
+  LEFT: 'left'
+}
+
+const RECORD_VERSION = 1
+// 记录头部：版本、每局分数、胜分差、封顶分、局数、先发球方（各 1 字节），逐分数量（Uint32）
+const RECORD_HEADER_SIZE = 10
+// 日志字节：bit0 得分方（0 主队 / 1 客队），bit1 该分结束一局
+const POINT_AWAY = 1
+const POINT_GAME_END = 2
+const MIN_LOG_CAPACITY = 64
+
+function sideIndex(side) {
+  return side === MATCH_SIDE.AWAY ? 1 : 0
+}
+
+function sideOf(index) {
+  return index ? MATCH_SIDE.AWAY : MATCH_SIDE.HOME
+}
+
+/**
+ * 规整比赛规则，缺省为 BWF 标准（21 分、胜 2 分、30 分封顶、三局两胜）
+ * @param {Object} rules - 规则
+ * @returns {{pointsToWin:number,winBy:number,maxPoints:number,bestOf:number,firstServe:string}} 规则
+ */
+export function normalizeMatchRules(rules) {
+  const source = rules || {}
+  const maxPoints = Number(source.maxPoints)
+  return {
+    pointsToWin: Math.min(255, Math.max(1, Number(source.pointsToWin) || 21)),
+    winBy: Math.min(255, Math.max(1, Number(source.winBy) || 2)),
+    // 0 表示不封顶
+    maxPoints: Number.isFinite(maxPoints) ? Math.min(255, Math.max(0, maxPoints)) : 30,
+    bestOf: Number(source.bestOf) === 1 ? 1 : 3,
+    firstServe: source.firstServe === MATCH_SIDE.AWAY ? MATCH_SIDE.AWAY : MATCH_SIDE.HOME
+  }
+}
+
+/**
+ * 创建比赛
+ * @param {Object} rules - 规则（见 normalizeMatchRules）
+ * @returns {Object} 比赛实例：point / undo / redo / reset / canUndo / canRedo / getState / serialize
+ */
+export function createMatch(rules) {
+  const config = normalizeMatchRules(rules)
+  const gamesToWin = Math.ceil(config.bestOf / 2)
+  // 领先方先到该分时局间休息；决胜局同时交换场地
+  const intervalAt = Math.ceil(config.pointsToWin / 2)
+  const firstServer = sideIndex(config.firstServe)
+
+  // 当前局比分、已结束各局比分（主、客交替）与局分
+  const score = new Uint16Array(2)
+  const gameScores = new Uint16Array(config.bestOf * 2)
+  const gamesWon = new Uint8Array(2)
+  let gamesPlayed = 0
+  let finished = false
+
+  // 逐分日志：[0, cursor) 为已生效的分，[cursor, length) 为可重做的分
+  let log = new Uint8Array(MIN_LOG_CAPACITY)
+  let cursor = 0
+  let length = 0
+
+  function gameWonBy(winner) {
+    const own = score[winner]
+    const other = score[1 - winner]
+    if (config.maxPoints > 0 && own >= config.maxPoints) return true
+    return own >= config.pointsToWin && own - other >= config.winBy
+  }
+
+  /**
+   * 应用一分，返回日志字节
+   */
+  function applyPoint(winner) {
+    score[winner]++
+    let entry = winner ? POINT_AWAY : 0
+    if (gameWonBy(winner)) {
+      entry |= POINT_GAME_END
+      gameScores[gamesPlayed * 2] = score[0]
+      gameScores[gamesPlayed * 2 + 1] = score[1]
+      gamesPlayed++
+      gamesWon[winner]++
+      if (gamesWon[winner] >= gamesToWin) {
+        // 比赛结束时保留最后一局的比分
+        finished = true
+      } else {
+        score[0] = 0
+        score[1] = 0
+      }
+    }
+    return entry
+  }
+
+  /**
+   * 回退一分（applyPoint 的逆操作）
+   */
+  function revertPoint(entry) {
+    const winner = entry & POINT_AWAY
+    if (entry & POINT_GAME_END) {
+      gamesPlayed--
+      gamesWon[winner]--
+      score[0] = gameScores[gamesPlayed * 2]
+      score[1] = gameScores[gamesPlayed * 2 + 1]
+      finished = false
+    }
+    score[winner]--
+  }
+
+  function server() {
+    // 上一分的得分方发球；新一局由上一局胜方先发
+    return cursor ? log[cursor - 1] & POINT_AWAY : firstServer
+  }
+
+  function deciding() {
+    return config.bestOf > 1 && gamesPlayed === config.bestOf - 1
+  }
+
+  return {
+    rules: config,
+
+    /**
+     * 记一分
+     * @param {string} side - 得分方 home/away
+     * @returns {boolean} 比赛已结束时为 false
+     */
+    point(side) {
+      if (finished) return false
+      if (cursor === log.length) {
+        const next = new Uint8Array(log.length * 2)
+        next.set(log)
+        log = next
+      }
+      log[cursor++] = applyPoint(sideIndex(side))
+      // 新的一分使重做历史失效
+      length = cursor
+      return true
+    },
+
+    /**
+     * 撤销上一分
+     * @returns {boolean} 没有可撤销的分时为 false
+     */
+    undo() {
+      if (!cursor) return false
+      revertPoint(log[--cursor])
+      return true
+    },
+
+    /**
+     * 重做被撤销的一分
+     * @returns {boolean} 没有可重做的分时为 false
+     */
+    redo() {
+      if (cursor >= length) return false
+      log[cursor] = applyPoint(log[cursor] & POINT_AWAY)
+      cursor++
+      return true
+    },
+
+    /**
+     * 清空比分与历史
+     */
+    reset() {
+      score.fill(0)
+      gameScores.fill(0)
+      gamesWon.fill(0)
+      gamesPlayed = 0
+      finished = false
+      cursor = 0
+      length = 0
+    },
+
+    canUndo() {
+      return cursor > 0
+    },
+
+    canRedo() {
+      return cursor < length
+    },
+
+    /**
+     * 当前比赛状态，写入调用方持有的对象（响应式对象原地更新）
+     * @param {Object} out - 输出对象，缺省时新建
+     * @returns {{score:Object,gamesWon:Object,games:Array<Object>,game:number,serveSide:string,serveCourt:string,
+     *   receiveCourt:string,homeEnd:number,interval:boolean,endsChanged:boolean,finished:boolean,winner:string|null,points:number,
+     *   canUndo:boolean,canRedo:boolean}}
+     *   homeEnd 为主队所在场地（0 为开局场地，1 为对侧）；interval / endsChanged 表示上一分刚触发局间休息 / 交换场地
+     */
+    getState(out = {}) {
+      const serving = server()
+      const last = cursor ? log[cursor - 1] : 0
+      const lastWinner = last & POINT_AWAY
+      const gameEnded = Boolean(cursor && (last & POINT_GAME_END))
+      // 上一分使领先方首次到达休息分（同一局内只会发生一次）
+      const interval = Boolean(cursor) && !gameEnded &&
+        score[lastWinner] === intervalAt && score[1 - lastWinner] < intervalAt
+      const decidingSwitched = deciding() && Math.max(score[0], score[1]) >= intervalAt && !finished
+
+      if (!out.score) out.score = { home: 0, away: 0 }
+      if (!out.gamesWon) out.gamesWon = { home: 0, away: 0 }
+      out.score.home = score[0]
+      out.score.away = score[1]
+      out.gamesWon.home = gamesWon[0]
+      out.gamesWon.away = gamesWon[1]
+      // 已结束各局只在局数变化时重建
+      if (!Array.isArray(out.games) || out.games.length !== gamesPlayed) {
+        out.games = []
+        for (let i = 0; i < gamesPlayed; i++) {
+          out.games.push({ home: gameScores[i * 2], away: gameScores[i * 2 + 1] })
+        }
+      }
+      out.game = finished ? gamesPlayed : gamesPlayed + 1
+      out.serveSide = sideOf(serving)
+      out.serveCourt = score[serving] % 2 === 0 ? MATCH_COURT.RIGHT : MATCH_COURT.LEFT
+      // 接发球方站在斜对角，按自身视角与发球方同名
+      out.receiveCourt = out.serveCourt
+      out.homeEnd = (gamesPlayed + (decidingSwitched ? 1 : 0)) % 2
+      out.interval = interval
+      out.endsChanged = (gameEnded && !finished) || (interval && deciding())
+      out.finished = finished
+      out.winner = finished ? sideOf(lastWinner) : null
+      out.points = cursor
+      out.canUndo = cursor > 0
+      out.canRedo = cursor < length
+      return out
+    },
+
+    /**
+     * 序列化为二进制记录：规则 + 逐分得分方（每分 1 bit），不含可重做的分
+     * @returns {Uint8Array} 记录
+     */
+    serialize() {
+      const bytes = new Uint8Array(RECORD_HEADER_SIZE + Math.ceil(cursor / 8))
+      const view = new DataView(bytes.buffer)
+      bytes[0] = RECORD_VERSION
+      bytes[1] = config.pointsToWin
+      bytes[2] = config.winBy
+      bytes[3] = config.maxPoints
+      bytes[4] = config.bestOf
+      bytes[5] = firstServer
+      view.setUint32(6, cursor, true)
+      for (let i = 0; i < cursor; i++) {
+        if (log[i] & POINT_AWAY) bytes[RECORD_HEADER_SIZE + (i >> 3)] |= 1 << (i & 7)
+      }
+      return bytes
+    }
+  }
+}
+
+/**
+ * 从二进制记录恢复比赛（重放逐分得分方）
+ * @param {Uint8Array} bytes - serialize 的结果
+ * @returns {Object|null} 比赛实例，格式不符时为 null
+ */
+export function restoreMatch(bytes) {
+  if (!bytes || bytes.length < RECORD_HEADER_SIZE || bytes[0] !== RECORD_VERSION) return null
+
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength)
+  const count = view.getUint32(6, true)
+  if (bytes.length < RECORD_HEADER_SIZE + Math.ceil(count / 8)) return null
+
+  const match = createMatch({
+    pointsToWin: bytes[1],
+    winBy: bytes[2],
+    maxPoints: bytes[3],
+    bestOf: bytes[4],
+    firstServe: sideOf(bytes[5])
+  })
+  for (let i = 0; i < count; i++) {
+    const away = bytes[RECORD_HEADER_SIZE + (i >> 3)] & (1 << (i & 7))
+    if (!match.point(away ? MATCH_SIDE.AWAY : MATCH_SIDE.HOME)) break
+  }
+  return match
+}
+
+/**
+ * 比赛记录编码为 Base64 文本（存入 scoreboard JSON）
+ * @param {Object} match - 比赛实例
+ * @returns {string} Base64 记录
+ */
+export function encodeMatchRecord(match) {
+  return encodeBase64(match.serialize())
+}
+
+/**
+ * 从 Base64 文本恢复比赛
+ * @param {string} text - encodeMatchRecord 的结果
+ * @returns {Object|null} 比赛实例，无效时为 null
+ */
+export function decodeMatchRecord(text) {
+  return text ? restoreMatch(decodeBase64(text)) : null
+}
+
+/**
+ * 计分牌持久化形态：比分摘要 + 二进制逐分记录（Base64），不含撤销历史
+ * @param {Object} match - 比赛实例
+ * @param {boolean} enabled - 是否启用计分牌
+ * @returns {Object} 计分牌
+ */
+export function exportMatchScoreboard(match, enabled) {
+  const state = match.getState()
+  return {
+    enabled: Boolean(enabled),
+    rules: match.rules,
+    score: state.score,
+    gamesWon: state.gamesWon,
+    games: state.games,
+    serveSide: state.serveSide,
+    finished: state.finished,
+    winner: state.winner,
+    record: encodeMatchRecord(match)
+  }
+}
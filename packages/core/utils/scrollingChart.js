@@ -0,0 +1,213 @@
+/**
+ * 增量滚动折线图
+ * 坐标轴只在全量重绘时画一次；每帧把绘图区按经过的时间整像素左移（getImageData / putImageData），
+ * 清空右侧新露出的窄条，只画上一帧之后新到的线段，每帧画布调用次数与新点数成正比；
+ * 画布已移动的时间按整像素累计，新线段与已画内容使用同一时间基准，不会逐帧漂移；
+ * 窗口内的点存放在按序列预分配的 Float64Array / Float32Array 中，过期点只移动起始下标，
+ * 写满时把有效段 copyWithin 到开头，稳定运行后每帧除平台的 ImageData 外不分配对象
+ */
+
+/**
+ * 创建滚动折线图
+ * @param {Object} ctx - canvas 2d 上下文
+ * @param {{width:number,height:number,padding?:number,windowMs?:number,axisColor?:string,lineWidth?:number,series:Array<{key:string,color:string,min:number,max:number}>}} options - 尺寸、时间窗口与序列配置
+ * @returns {Object} 图表实例：append / render / invalidate / getStats
+ */
+export function createScrollingChart(ctx, options) {
+  const width = options.width
+  const height = options.height
+  const padding = options.padding === undefined ? 20 : options.padding
+  const windowMs = options.windowMs || 60000
+  const lineWidth = options.lineWidth || 2
+  const axisColor = options.axisColor || '#CCCCCC'
+
+  // 绘图区不含坐标轴线本身，左移时坐标轴保持不动
+  const plotLeft = padding + 1
+  const plotRight = width - padding
+  const plotTop = padding
+  const plotBottom = height - padding - 1
+  const plotWidth = plotRight - plotLeft
+  const plotHeight = plotBottom - plotTop
+  const pixelsPerMs = (width - padding * 2) / windowMs
+
+  const canShift = typeof ctx.getImageData === 'function' && typeof ctx.putImageData === 'function'
+
+  // 点缓冲初始容量（按 1 秒 10 个点预留一个窗口），写满且无法压缩时翻倍
+  const initialCapacity = Math.max(64, Math.ceil(windowMs / 100))
+
+  // key -> { color, min, max, t / v（窗口内的点，下标 begin..end，用于全量重绘）, drawn: 已画到的下标 }
+  const series = new Map()
+  const entries = []
+  options.series.forEach(config => {
+    const entry = {
+      color: config.color,
+      min: config.min,
+      max: config.max,
+      t: new Float64Array(initialCapacity),
+      v: new Float32Array(initialCapacity),
+      begin: 0,
+      end: 0,
+      drawn: 0
+    }
+    series.set(config.key, entry)
+    entries.push(entry)
+  })
+
+  // 画布内容对应的时间：x = plotRight - (renderedAt - t) * pixelsPerMs
+  let renderedAt = 0
+  let valid = false
+
+  const stats = { frames: 0, fullRedraws: 0, drawCalls: 0, startedAt: 0 }
+
+  function xOf(t) {
+    return plotRight - (renderedAt - Math.min(t, renderedAt)) * pixelsPerMs
+  }
+
+  function yOf(entry, v) {
+    const ratio = (Math.min(entry.max, Math.max(entry.min, v)) - entry.min) / (entry.max - entry.min || 1)
+    return plotBottom - plotHeight * ratio
+  }
+
+  function strokeRange(entry, from, to) {
+    if (to - from < 2) return
+    ctx.beginPath()
+    ctx.strokeStyle = entry.color
+    ctx.lineWidth = lineWidth
+    ctx.moveTo(xOf(entry.t[from]), yOf(entry, entry.v[from]))
+    for (let i = from + 1; i < to; i++) {
+      ctx.lineTo(xOf(entry.t[i]), yOf(entry, entry.v[i]))
+    }
+    ctx.stroke()
+    stats.drawCalls += to - from + 2
+  }
+
+  /**
+   * 为一个新点腾出位置：先把有效段移到开头，仍然写满才扩容
+   */
+  function reserve(entry) {
+    if (entry.end < entry.t.length) return
+    if (entry.begin > 0) {
+      const shift = entry.begin
+      entry.t.copyWithin(0, shift, entry.end)
+      entry.v.copyWithin(0, shift, entry.end)
+      entry.end -= shift
+      entry.drawn = Math.max(0, entry.drawn - shift)
+      entry.begin = 0
+      return
+    }
+    const t = new Float64Array(entry.t.length * 2)
+    const v = new Float32Array(entry.v.length * 2)
+    t.set(entry.t)
+    v.set(entry.v)
+    entry.t = t
+    entry.v = v
+  }
+
+  function prune(now) {
+    const oldest = now - windowMs
+    for (let k = 0; k < entries.length; k++) {
+      const entry = entries[k]
+      // 保留窗口外的最后一点，使首段线从左边缘画起
+      while (entry.begin + 1 < entry.end && entry.t[entry.begin + 1] < oldest) entry.begin++
+      if (entry.drawn < entry.begin) entry.drawn = entry.begin
+    }
+  }
+
+  function fullRedraw(now) {
+    stats.fullRedraws++
+    renderedAt = now
+    ctx.clearRect(0, 0, width, height)
+
+    ctx.beginPath()
+    ctx.strokeStyle = axisColor
+    ctx.lineWidth = 1
+    ctx.moveTo(padding, padding)
+    ctx.lineTo(padding, height - padding)
+    ctx.lineTo(width - padding, height - padding)
+    ctx.stroke()
+    stats.drawCalls += 6
+
+    for (let k = 0; k < entries.length; k++) {
+      strokeRange(entries[k], entries[k].begin, entries[k].end)
+      entries[k].drawn = entries[k].end
+    }
+    valid = true
+  }
+
+  function incrementalDraw(now) {
+    const shift = Math.floor((now - renderedAt) * pixelsPerMs)
+    if (shift > 0) {
+      const image = ctx.getImageData(plotLeft + shift, plotTop, plotWidth - shift, plotHeight)
+      ctx.putImageData(image, plotLeft, plotTop)
+      ctx.clearRect(plotRight - shift, plotTop, shift, plotHeight)
+      stats.drawCalls += 3
+      renderedAt += shift / pixelsPerMs
+    }
+
+    for (let k = 0; k < entries.length; k++) {
+      const entry = entries[k]
+      // 从上一帧的最后一点连到新点；晚于画布时间的点留到下一帧，避免画在右边缘之外
+      let end = entry.end
+      while (end > entry.drawn && entry.t[end - 1] > renderedAt) end--
+      strokeRange(entry, Math.max(entry.begin, entry.drawn - 1), end)
+      entry.drawn = end
+    }
+  }
+
+  return {
+    /**
+     * 追加一个数据点（按时间递增），下一次 render 时绘制
+     * @param {string} key - 序列 key
+     * @param {number} t - 时间戳（毫秒）
+     * @param {number} v - 数值
+     */
+    append(key, t, v) {
+      const entry = series.get(key)
+      if (!entry) return
+      reserve(entry)
+      entry.t[entry.end] = t
+      entry.v[entry.end] = v
+      entry.end++
+    },
+
+    /**
+     * 绘制一帧：可增量时只移动画布并画新线段，否则全量重绘
+     * @param {number} now - 当前时间戳（毫秒）
+     */
+    render(now = Date.now()) {
+      if (!stats.startedAt) stats.startedAt = now
+      stats.frames++
+      prune(now)
+
+      const elapsed = now - renderedAt
+      if (!valid || !canShift || elapsed < 0 || elapsed * pixelsPerMs >= plotWidth) {
+        fullRedraw(now)
+      } else {
+        incrementalDraw(now)
+      }
+    },
+
+    /**
+     * 标记下一帧全量重绘（画布尺寸或配置变化、页面重新显示时）
+     */
+    invalidate() {
+      valid = false
+    },
+
+    /**
+     * 绘制统计
+     * @param {number} now - 当前时间戳（毫秒）
+     * @returns {{frames:number,fullRedraws:number,drawCalls:number,drawCallsPerFrame:number,drawCallsPerSecond:number}}
+     */
+    getStats(now = Date.now()) {
+      const seconds = Math.max(1, now - (stats.startedAt || now)) / 1000
+      return {
+        frames: stats.frames,
+        fullRedraws: stats.fullRedraws,
+        drawCalls: stats.drawCalls,
+        drawCallsPerFrame: stats.frames ? Math.round(stats.drawCalls / stats.frames * 10) / 10 : 0,
+        drawCallsPerSecond: Math.round(stats.drawCalls / seconds * 10) / 10
+      }
+    }
+  }
+}
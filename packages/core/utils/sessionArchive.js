@@ -0,0 +1,190 @@
+/**
+ * 会话二进制归档格式（FSAR）
+ *
+ * 布局（小端序）：
+ *   头部   magic 'FSAR' | version u16 | headerSize u16 | blockCount u16 | 保留 u16
+ *          startTime f64 | endTime f64 | 汇总字段（见 SUMMARY_FIELDS）
+ *   索引   每块 16 字节：blockId u16 | 保留 u16 | count u32 | offset u32 | byteLength u32
+ *   数据块 列式存储：时间偏移 Uint32[count]（相对 startTime 的毫秒）+ 数值 Float32[count]
+ *
+ * 数据块按 8 字节对齐，读取时可直接在文件缓冲区上建立类型化数组视图，无需解析或拷贝
+ */
+
+export const ARCHIVE_MAGIC = 0x52415346 // 'FSAR'
+export const ARCHIVE_VERSION = 1
+
+// 数据块编号
+export const ARCHIVE_BLOCK = {
+  HEART_RATE: 1,
+  SPEED: 2
+}
+
+// 汇总字段及其存储类型，顺序即写入顺序
+const SUMMARY_FIELDS = [
+  ['duration', 'Uint32'],
+  ['calories', 'Float32'],
+  ['maxSpeed', 'Float32'],
+  ['avgHeartRate', 'Float32'],
+  ['maxHeartRate', 'Float32'],
+  ['minHeartRate', 'Float32'],
+  ['strokes', 'Uint32'],
+  ['smashes', 'Uint32'],
+  ['forehand', 'Uint32'],
+  ['backhand', 'Uint32']
+]
+
+const PREAMBLE_SIZE = 12
+const SUMMARY_OFFSET = PREAMBLE_SIZE + 16
+export const ARCHIVE_HEADER_SIZE = SUMMARY_OFFSET + SUMMARY_FIELDS.length * 4
+export const ARCHIVE_INDEX_ENTRY_SIZE = 16
+
+function align8(value) {
+  return (value + 7) & ~7
+}
+
+/**
+ * 把 [{t, v}] 序列转换为列式序列
+ * @param {Array<{t:number,v:number}>} series - 序列
+ * @param {number} baseTime - 时间基准（毫秒）
+ * @returns {{baseTime:number,t:Uint32Array,v:Float32Array,length:number}} 列式序列
+ */
+export function toColumnarSeries(series, baseTime) {
+  const list = Array.isArray(series) ? series : []
+  const t = new Uint32Array(list.length)
+  const v = new Float32Array(list.length)
+
+  for (let i = 0; i < list.length; i++) {
+    t[i] = Math.max(0, (list[i].t || 0) - baseTime)
+    v[i] = Number(list[i].v) || 0
+  }
+
+  return { baseTime, t, v, length: list.length }
+}
+
+/**
+ * 空的列式序列
+ * @param {number} baseTime - 时间基准（毫秒）
+ * @returns {Object} 列式序列
+ */
+export function emptyColumnarSeries(baseTime = 0) {
+  return { baseTime, t: new Uint32Array(0), v: new Float32Array(0), length: 0 }
+}
+
+/**
+ * 编码会话归档
+ * @param {Object} session - 会话数据（heartRateSeries/speedSeries 为 [{t, v}]）
+ * @returns {Uint8Array} 归档字节
+ */
+export function encodeSessionArchive(session) {
+  const startTime = session.startTime || session.start_time || 0
+  const blocks = [
+    [ARCHIVE_BLOCK.HEART_RATE, session.heartRateSeries || []],
+    [ARCHIVE_BLOCK.SPEED, session.speedSeries || []]
+  ]
+
+  let offset = align8(ARCHIVE_HEADER_SIZE + blocks.length * ARCHIVE_INDEX_ENTRY_SIZE)
+  const layout = blocks.map(([blockId, series]) => {
+    const count = series.length
+    const entry = { blockId, series, count, offset, byteLength: count * 8 }
+    offset = align8(offset + entry.byteLength)
+    return entry
+  })
+
+  const bytes = new Uint8Array(offset)
+  const view = new DataView(bytes.buffer)
+
+  view.setUint32(0, ARCHIVE_MAGIC, true)
+  view.setUint16(4, ARCHIVE_VERSION, true)
+  view.setUint16(6, ARCHIVE_HEADER_SIZE, true)
+  view.setUint16(8, blocks.length, true)
+  view.setFloat64(PREAMBLE_SIZE, startTime, true)
+  view.setFloat64(PREAMBLE_SIZE + 8, session.endTime || session.end_time || 0, true)
+
+  SUMMARY_FIELDS.forEach(([field, type], i) => {
+    view[`set${type}`](SUMMARY_OFFSET + i * 4, Number(session[field]) || 0, true)
+  })
+
+  layout.forEach((entry, i) => {
+    const base = ARCHIVE_HEADER_SIZE + i * ARCHIVE_INDEX_ENTRY_SIZE
+    view.setUint16(base, entry.blockId, true)
+    view.setUint32(base + 4, entry.count, true)
+    view.setUint32(base + 8, entry.offset, true)
+    view.setUint32(base + 12, entry.byteLength, true)
+
+    const columns = toColumnarSeries(entry.series, startTime)
+    bytes.set(new Uint8Array(columns.t.buffer), entry.offset)
+    bytes.set(new Uint8Array(columns.v.buffer), entry.offset + entry.count * 4)
+  })
+
+  return bytes
+}
+
+/**
+ * 解码归档头部与索引
+ * @param {Uint8Array} bytes - 至少包含头部与索引的字节
+ * @returns {{startTime:number,endTime:number,summary:Object,blocks:Array}|null} 头部信息，格式不符时返回 null
+ */
+export function decodeArchiveHeader(bytes) {
+  if (!bytes || bytes.byteLength < ARCHIVE_HEADER_SIZE) return null
+
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength)
+  if (view.getUint32(0, true) !== ARCHIVE_MAGIC) return null
+  if (view.getUint16(4, true) > ARCHIVE_VERSION) return null
+
+  const headerSize = view.getUint16(6, true)
+  const blockCount = view.getUint16(8, true)
+  if (bytes.byteLength < headerSize + blockCount * ARCHIVE_INDEX_ENTRY_SIZE) return null
+
+  const summary = {}
+  SUMMARY_FIELDS.forEach(([field, type], i) => {
+    summary[field] = view[`get${type}`](SUMMARY_OFFSET + i * 4, true)
+  })
+
+  const blocks = []
+  for (let i = 0; i < blockCount; i++) {
+    const base = headerSize + i * ARCHIVE_INDEX_ENTRY_SIZE
+    blocks.push({
+      blockId: view.getUint16(base, true),
+      count: view.getUint32(base + 4, true),
+      offset: view.getUint32(base + 8, true),
+      byteLength: view.getUint32(base + 12, true)
+    })
+  }
+
+  return {
+    startTime: view.getFloat64(PREAMBLE_SIZE, true),
+    endTime: view.getFloat64(PREAMBLE_SIZE + 8, true),
+    summary,
+    blocks
+  }
+}
+
+/**
+ * 在数据块字节上建立列式序列视图（对齐时零拷贝）
+ * @param {Uint8Array} bytes - 数据块字节（从块起点开始）
+ * @param {number} count - 点数
+ * @param {number} baseTime - 时间基准（毫秒）
+ * @returns {{baseTime:number,t:Uint32Array,v:Float32Array,length:number}} 列式序列
+ */
+export function viewSeriesBlock(bytes, count, baseTime) {
+  if (!count) return emptyColumnarSeries(baseTime)
+
+  // 平台返回的缓冲区偏移不满足 4 字节对齐时只能拷贝一次
+  const source = bytes.byteOffset % 4 === 0 ? bytes : bytes.slice()
+
+  return {
+    baseTime,
+    t: new Uint32Array(source.buffer, source.byteOffset, count),
+    v: new Float32Array(source.buffer, source.byteOffset + count * 4, count),
+    length: count
+  }
+}
+
+/**
+ * 头部与索引的最大字节数，用于首次定长读取
+ * @param {number} maxBlocks - 预期最多的数据块数量
+ * @returns {number} 字节数
+ */
+export function archivePrefixSize(maxBlocks = 8) {
+  return ARCHIVE_HEADER_SIZE + maxBlocks * ARCHIVE_INDEX_ENTRY_SIZE
+}
@@ -1,57 +1,25 @@
 /**
- * 存储工具类 - 使用BlueOS storage API
+ * 存储工具类 - 基于日志结构键值存储（kvStore）
+ * 每次写入只追加一条记录，不再整体重写
  */
 
-// 在实际环境中应该使用以下方式导入
-// import storage from '@blueos.storage.storage';
+import { createKvStore } from './kvStore';
 
-// 创建一个模拟的storage API
-const mockStorage = {
-  get(options) {
-    console.log('使用模拟storage.get', options.key);
-    if (typeof options.success === 'function') {
-      options.success('');
-    }
-  },
-  getSync(options) {
-    console.log('使用模拟storage.getSync', options.key);
-    return '';
-  },
-  set(options) {
-    console.log('使用模拟storage.set', options.key);
-    if (typeof options.success === 'function') {
-      options.success();
-    }
-  },
-  delete(options) {
-    console.log('使用模拟storage.delete', options.key);
-    if (typeof options.success === 'function') {
-      options.success();
-    }
-  },
-  clear(options) {
-    console.log('使用模拟storage.clear');
-    if (typeof options.success === 'function') {
-      options.success();
-    }
-  }
+const kv = createKvStore('app');
+
+// 会话按 session:<id> 分键存储
+const SESSION_KEY_PREFIX = 'session:';
+const SETTINGS_KEY = 'settings';
+
+// 运动设置默认值
+const DEFAULT_SETTINGS = {
+  vibrateOnWarning: true,
+  heartRateMin: 60,
+  heartRateMax: 180
 };
 
-/**
- * 解析JSON数据，处理可能的错误
- * @param {string} data - JSON字符串
- * @param {any} defaultValue - 解析失败时的默认值
- * @returns {any} 解析后的数据或默认值
- */
-function safeParseJSON(data, defaultValue) {
-  if (!data) return defaultValue;
-  
-  try {
-    return JSON.parse(data);
-  } catch (e) {
-    console.error('JSON解析错误:', e);
-    return defaultValue;
-  }
+function sessionKey(id) {
+  return `${SESSION_KEY_PREFIX}${id}`;
 }
 
 /**
@@ -59,11 +27,50 @@ function safeParseJSON(data, defaultValue) {
  */
 const storageManager = {
   /**
-   * 初始化存储
+   * 初始化存储（打开日志并重建索引）
    * @returns {Promise} 初始化Promise
    */
   init() {
-    return Promise.resolve();
+    return kv.open();
+  },
+
+  /**
+   * 读取键值
+   * @param {string} key - 键
+   * @param {any} defaultValue - 不存在时的默认值
+   * @returns {Promise<any>} 值Promise
+   */
+  getItem(key, defaultValue) {
+    return kv.open().then(() => kv.get(key, defaultValue));
+  },
+
+  /**
+   * 写入键值
+   * @param {string} key - 键
+   * @param {any} value - 可 JSON 序列化的值
+   * @returns {Promise<boolean>} 写入结果Promise
+   */
+  setItem(key, value) {
+    return kv.set(key, value)
+      .then(() => true)
+      .catch(e => {
+        console.error('写入存储错误:', e);
+        return false;
+      });
+  },
+
+  /**
+   * 删除键值
+   * @param {string} key - 键
+   * @returns {Promise<boolean>} 删除结果Promise
+   */
+  removeItem(key) {
+    return kv.remove(key)
+      .then(() => true)
+      .catch(e => {
+        console.error('删除存储错误:', e);
+        return false;
+      });
   },
 
   /**
@@ -72,29 +79,8 @@ const storageManager = {
    * @returns {Promise} 保存Promise
    */
   saveSession(session) {
-    return new Promise((resolve) => {
-      try {
-        // 获取现有会话列表
-        const sessions = this.getAllSessionsSync() || [];
-        
-        // 生成唯一ID
-        const newSession = { ...session, id: Date.now() };
-        
-        // 添加到列表
-        sessions.push(newSession);
-        
-        // 保存会话列表
-        mockStorage.set({
-          key: 'sessions',
-          value: JSON.stringify(sessions),
-          success: () => resolve(newSession),
-          fail: () => resolve(newSession)
-        });
-      } catch (e) {
-        console.error('保存会话错误:', e);
-        resolve({ ...session, id: Date.now() });
-      }
-    });
+    const newSession = { ...session, id: Date.now() };
+    return this.setItem(sessionKey(newSession.id), newSession).then(() => newSession);
   },
 
   /**
@@ -102,36 +88,17 @@ const storageManager = {
    * @returns {Promise<Array>} 会话列表Promise
    */
   getAllSessions() {
-    return new Promise((resolve) => {
-      try {
-        mockStorage.get({
-          key: 'sessions',
-          success: (data) => {
-            const sessions = safeParseJSON(data, []);
-            resolve(Array.isArray(sessions) ? sessions : []);
-          },
-          fail: () => resolve([])
-        });
-      } catch (e) {
-        console.error('获取会话列表错误:', e);
-        resolve([]);
-      }
-    });
+    return kv.open().then(() => this.getAllSessionsSync());
   },
 
   /**
-   * 同步获取所有运动会话
+   * 同步获取所有运动会话（需已完成 init）
    * @returns {Array} 会话列表
    */
   getAllSessionsSync() {
-    try {
-      const data = mockStorage.getSync({ key: 'sessions' });
-      const sessions = safeParseJSON(data, []);
-      return Array.isArray(sessions) ? sessions : [];
-    } catch (e) {
-      console.error('同步获取会话列表错误:', e);
-      return [];
-    }
+    return kv.keys(SESSION_KEY_PREFIX)
+      .map(key => kv.get(key))
+      .filter(Boolean);
   },
 
   /**
@@ -140,12 +107,7 @@ const storageManager = {
    * @returns {Promise<Object|null>} 会话Promise
    */
   getSession(id) {
-    return new Promise((resolve) => {
-      this.getAllSessions().then(sessions => {
-        const session = sessions.find(s => s && s.id === id) || null;
-        resolve(session);
-      });
-    });
+    return this.getItem(sessionKey(id), null);
   },
 
   /**
@@ -154,31 +116,11 @@ const storageManager = {
    * @returns {Promise<boolean>} 更新结果Promise
    */
   updateSession(session) {
-    return new Promise((resolve) => {
-      try {
-        if (!session || !session.id) {
-          resolve(false);
-          return;
-        }
-        
-        this.getAllSessions().then(sessions => {
-          const index = sessions.findIndex(s => s && s.id === session.id);
-          if (index !== -1) {
-            sessions[index] = session;
-            mockStorage.set({
-              key: 'sessions',
-              value: JSON.stringify(sessions),
-              success: () => resolve(true),
-              fail: () => resolve(false)
-            });
-          } else {
-            resolve(false);
-          }
-        });
-      } catch (e) {
-        console.error('更新会话错误:', e);
-        resolve(false);
-      }
+    if (!session || !session.id) return Promise.resolve(false);
+
+    return kv.open().then(() => {
+      if (kv.get(sessionKey(session.id)) === undefined) return false;
+      return this.setItem(sessionKey(session.id), session);
     });
   },
 
@@ -188,25 +130,9 @@ const storageManager = {
    * @returns {Promise<boolean>} 删除结果Promise
    */
   deleteSession(id) {
-    return new Promise((resolve) => {
-      try {
-        this.getAllSessions().then(sessions => {
-          const filteredSessions = sessions.filter(s => s && s.id !== id);
-          if (filteredSessions.length !== sessions.length) {
-            mockStorage.set({
-              key: 'sessions',
-              value: JSON.stringify(filteredSessions),
-              success: () => resolve(true),
-              fail: () => resolve(false)
-            });
-          } else {
-            resolve(false);
-          }
-        });
-      } catch (e) {
-        console.error('删除会话错误:', e);
-        resolve(false);
-      }
+    return kv.open().then(() => {
+      if (kv.get(sessionKey(id)) === undefined) return false;
+      return this.removeItem(sessionKey(id));
     });
   },
 
@@ -215,18 +141,13 @@ const storageManager = {
    * @returns {Promise<boolean>} 清空结果Promise
    */
   clearAllSessions() {
-    return new Promise((resolve) => {
-      try {
-        mockStorage.delete({
-          key: 'sessions',
-          success: () => resolve(true),
-          fail: () => resolve(false)
-        });
-      } catch (e) {
+    return kv.open()
+      .then(() => Promise.all(kv.keys(SESSION_KEY_PREFIX).map(key => kv.remove(key))))
+      .then(() => true)
+      .catch(e => {
         console.error('清空会话错误:', e);
-        resolve(false);
-      }
-    });
+        return false;
+      });
   },
 
   /**
@@ -235,21 +156,7 @@ const storageManager = {
    * @returns {Promise<boolean>} 保存结果Promise
    */
   saveSettings(settings) {
-    return new Promise((resolve) => {
-      try {
-        const validSettings = settings || {};
-        
-        mockStorage.set({
-          key: 'settings',
-          value: JSON.stringify(validSettings),
-          success: () => resolve(true),
-          fail: () => resolve(false)
-        });
-      } catch (e) {
-        console.error('保存设置错误:', e);
-        resolve(false);
-      }
-    });
+    return this.setItem(SETTINGS_KEY, settings || {});
   },
 
   /**
@@ -257,37 +164,34 @@ const storageManager = {
    * @returns {Promise<Object>} 用户设置Promise
    */
   getSettings() {
-    return new Promise((resolve) => {
-      try {
-        mockStorage.get({
-          key: 'settings',
-          success: (data) => {
-            const settings = safeParseJSON(data, {});
-            resolve(typeof settings === 'object' && settings !== null ? settings : {});
-          },
-          fail: () => resolve({})
-        });
-      } catch (e) {
-        console.error('获取设置错误:', e);
-        resolve({});
-      }
-    });
+    return kv.open().then(() => this.getSettingsSync());
   },
 
   /**
-   * 同步获取用户设置
+   * 同步获取用户设置（需已完成 init，未设置的项取默认值）
    * @returns {Object} 用户设置
    */
   getSettingsSync() {
-    try {
-      const data = mockStorage.getSync({ key: 'settings' });
-      const settings = safeParseJSON(data, {});
-      return typeof settings === 'object' && settings !== null ? settings : {};
-    } catch (e) {
-      console.error('同步获取设置错误:', e);
-      return {};
-    }
+    const settings = kv.get(SETTINGS_KEY, {});
+    return { ...DEFAULT_SETTINGS, ...(typeof settings === 'object' && settings !== null ? settings : {}) };
   }
 };
 
-export default storageManager; 
\ No newline at end of file
+/**
+ * 同步获取运动设置（需已完成 storageManager.init）
+ * @returns {Object} 运动设置
+ */
+export function getSettings() {
+  return storageManager.getSettingsSync();
+}
+
+/**
+ * 保存运动设置
+ * @param {Object} settings - 运动设置
+ * @returns {Promise<boolean>} 保存结果Promise
+ */
+export function saveSettings(settings) {
+  return storageManager.saveSettings(settings);
+}
+
+export default storageManager;
@@ -0,0 +1,97 @@
+/**
+ * tar（POSIX ustar）条目头编解码
+ * 只处理普通文件条目；条目数据按 512 字节块对齐，归档以两个全零块结束
+ */
+import { encodeUtf8, decodeUtf8 } from './utf8'
+
+export const TAR_BLOCK_SIZE = 512
+
+function writeField(header, offset, length, text) {
+  const bytes = encodeUtf8(text)
+  header.set(bytes.subarray(0, length), offset)
+}
+
+function writeOctal(header, offset, length, value) {
+  // 定长八进制，末尾保留一个 NUL
+  const text = Math.floor(value).toString(8).padStart(length - 1, '0')
+  writeField(header, offset, length - 1, text)
+}
+
+function readString(header, offset, length) {
+  let end = offset
+  while (end < offset + length && header[end] !== 0) end++
+  return decodeUtf8(header, offset, end)
+}
+
+function readOctal(header, offset, length) {
+  const text = readString(header, offset, length).trim()
+  return text ? parseInt(text, 8) : 0
+}
+
+function checksum(header) {
+  let sum = 0
+  for (let i = 0; i < TAR_BLOCK_SIZE; i++) {
+    // 校验和字段按 8 个空格计算
+    sum += i >= 148 && i < 156 ? 0x20 : header[i]
+  }
+  return sum
+}
+
+/**
+ * 数据块之后需要补齐的字节数
+ * @param {number} size - 条目数据长度
+ * @returns {number} 补齐字节数
+ */
+export function tarPadding(size) {
+  const rest = size % TAR_BLOCK_SIZE
+  return rest ? TAR_BLOCK_SIZE - rest : 0
+}
+
+/**
+ * 编码普通文件条目头
+ * @param {string} name - 条目路径（UTF-8 不超过 100 字节）
+ * @param {number} size - 数据长度
+ * @param {number} mtime - 修改时间（毫秒）
+ * @returns {Uint8Array} 512 字节条目头
+ */
+export function encodeTarHeader(name, size, mtime = Date.now()) {
+  const header = new Uint8Array(TAR_BLOCK_SIZE)
+
+  writeField(header, 0, 100, name)
+  writeOctal(header, 100, 8, 0o644)
+  writeOctal(header, 108, 8, 0)
+  writeOctal(header, 116, 8, 0)
+  writeOctal(header, 124, 12, size)
+  writeOctal(header, 136, 12, mtime / 1000)
+  header[156] = 0x30 // '0' 普通文件
+  writeField(header, 257, 6, 'ustar')
+  writeField(header, 263, 2, '00')
+
+  const sum = checksum(header).toString(8).padStart(6, '0')
+  writeField(header, 148, 6, sum)
+  header[154] = 0
+  header[155] = 0x20
+
+  return header
+}
+
+/**
+ * 解码条目头
+ * @param {Uint8Array} header - 512 字节条目头
+ * @returns {{name:string,size:number,mtime:number,type:string}|null} 条目信息；归档结束块或校验失败时为 null
+ */
+export function decodeTarHeader(header) {
+  if (!header || header.length < TAR_BLOCK_SIZE) return null
+  if (header.every(byte => byte === 0)) return null
+  if (readOctal(header, 148, 8) !== checksum(header)) return null
+
+  const prefix = readString(header, 345, 155)
+  const name = readString(header, 0, 100)
+
+  return {
+    name: prefix ? `${prefix}/${name}` : name,
+    size: readOctal(header, 124, 12),
+    mtime: readOctal(header, 136, 12) * 1000,
+    type: String.fromCharCode(header[156] || 0x30)
+  }
+}
@@ -0,0 +1,77 @@
+/**
+ * UTF-8 编解码（运行时没有 TextEncoder/TextDecoder 时使用手写实现）
+ */
+
+/**
+ * 字符串编码为 UTF-8 字节
+ * @param {string} text - 字符串
+ * @returns {Uint8Array} UTF-8 字节
+ */
+export function encodeUtf8(text) {
+  const str = String(text)
+  if (typeof TextEncoder !== 'undefined') return new TextEncoder().encode(str)
+
+  const bytes = []
+  for (let i = 0; i < str.length; i++) {
+    let code = str.charCodeAt(i)
+
+    // 代理对合并为一个码点
+    if (code >= 0xD800 && code <= 0xDBFF && i + 1 < str.length) {
+      const next = str.charCodeAt(i + 1)
+      if (next >= 0xDC00 && next <= 0xDFFF) {
+        code = 0x10000 + ((code - 0xD800) << 10) + (next - 0xDC00)
+        i++
+      }
+    }
+
+    if (code < 0x80) {
+      bytes.push(code)
+    } else if (code < 0x800) {
+      bytes.push(0xC0 | (code >> 6), 0x80 | (code & 0x3F))
+    } else if (code < 0x10000) {
+      bytes.push(0xE0 | (code >> 12), 0x80 | ((code >> 6) & 0x3F), 0x80 | (code & 0x3F))
+    } else {
+      bytes.push(
+        0xF0 | (code >> 18),
+        0x80 | ((code >> 12) & 0x3F),
+        0x80 | ((code >> 6) & 0x3F),
+        0x80 | (code & 0x3F)
+      )
+    }
+  }
+  return new Uint8Array(bytes)
+}
+
+/**
+ * UTF-8 字节解码为字符串
+ * @param {Uint8Array} bytes - 字节
+ * @param {number} start - 起始下标（含）
+ * @param {number} end - 结束下标（不含）
+ * @returns {string} 字符串
+ */
+export function decodeUtf8(bytes, start = 0, end = bytes.length) {
+  if (typeof TextDecoder !== 'undefined') return new TextDecoder().decode(bytes.subarray(start, end))
+
+  let result = ''
+  let i = start
+  while (i < end) {
+    const byte = bytes[i++]
+    let code = byte
+
+    if (byte >= 0xF0) {
+      code = ((byte & 0x07) << 18) | ((bytes[i++] & 0x3F) << 12) | ((bytes[i++] & 0x3F) << 6) | (bytes[i++] & 0x3F)
+    } else if (byte >= 0xE0) {
+      code = ((byte & 0x0F) << 12) | ((bytes[i++] & 0x3F) << 6) | (bytes[i++] & 0x3F)
+    } else if (byte >= 0xC0) {
+      code = ((byte & 0x1F) << 6) | (bytes[i++] & 0x3F)
+    }
+
+    if (code >= 0x10000) {
+      code -= 0x10000
+      result += String.fromCharCode(0xD800 + (code >> 10), 0xDC00 + (code & 0x3FF))
+    } else {
+      result += String.fromCharCode(code)
+    }
+  }
+  return result
+}
@@ -0,0 +1,174 @@
+/**
+ * 疲劳检测模块
+ * 以运动时长（分钟）为自变量，分别对逐拍拍速与心率做指数加权递推最小二乘（EW-RLS）直线拟合：
+ * 拍速斜率为负表示挥拍变慢，心率斜率为正表示心率漂移；
+ * 每个样本只更新 2×2 协方差与 2 个系数，O(1)，不保留历史样本
+ */
+
+// 疲劳等级
+export const FATIGUE_LEVEL = {
+  NORMAL: 0,
+  MILD: 1,
+  MODERATE: 2,
+  SEVERE: 3
+}
+
+export const FATIGUE_LEVEL_TEXT = ['正常', '轻度', '中度', '重度']
+
+// 遗忘因子：有效窗口约 1 / (1 - λ) 个样本（拍速约 100 拍，心率约 200 个采样）
+const SPEED_FORGETTING = 0.99
+const HEART_RATE_FORGETTING = 0.995
+// 协方差初值，越大初期越信任新样本
+const INITIAL_COVARIANCE = 1e4
+// 开始给出等级所需的最少样本与运动时长
+const MIN_STROKES = 30
+const MIN_HEART_RATE_SAMPLES = 60
+const MIN_ELAPSED_MINUTES = 5
+// 拍速低于该值的挥拍不参与拟合（检测噪声）
+const MIN_STROKE_SPEED = 5
+// 疲劳分 = 拍速每 10 分钟下降的百分比 + 拍速下降时心率每 10 分钟上升百分比的一半；等级阈值
+const HEART_RATE_DRIFT_WEIGHT = 0.5
+const LEVEL_THRESHOLDS = [5, 10, 20]
+
+/**
+ * 新建一条 EW-RLS 直线拟合 y = a + b·x
+ * @param {number} forgetting - 遗忘因子 λ
+ * @returns {Object} 拟合状态
+ */
+function createLineFit(forgetting) {
+  return {
+    forgetting,
+    a: 0,
+    b: 0,
+    p00: INITIAL_COVARIANCE,
+    p01: 0,
+    p11: INITIAL_COVARIANCE,
+    count: 0,
+    lastX: 0
+  }
+}
+
+/**
+ * 用一个样本更新拟合：k = Px / (λ + xᵀPx)，θ += k·e，P = (P - k·xᵀP) / λ
+ * @param {Object} fit - 拟合状态
+ * @param {number} x - 自变量
+ * @param {number} y - 观测值
+ */
+function updateLineFit(fit, x, y) {
+  if (!fit.count) fit.a = y
+
+  const px0 = fit.p00 + fit.p01 * x
+  const px1 = fit.p01 + fit.p11 * x
+  const denom = fit.forgetting + px0 + px1 * x
+  const k0 = px0 / denom
+  const k1 = px1 / denom
+  const error = y - (fit.a + fit.b * x)
+
+  fit.a += k0 * error
+  fit.b += k1 * error
+  fit.p00 = (fit.p00 - k0 * px0) / fit.forgetting
+  fit.p01 = (fit.p01 - k0 * px1) / fit.forgetting
+  fit.p11 = (fit.p11 - k1 * px1) / fit.forgetting
+  fit.count++
+  fit.lastX = x
+}
+
+/**
+ * 拟合直线在最近一个样本处的相对斜率（每 10 分钟变化的百分比）
+ * @param {Object} fit - 拟合状态
+ * @returns {number} 百分比
+ */
+function relativeSlope(fit) {
+  const level = fit.a + fit.b * fit.lastX
+  return level > 0 ? fit.b * 10 / level * 100 : 0
+}
+
+let startTime = 0
+let speedFit = createLineFit(SPEED_FORGETTING)
+let heartRateFit = createLineFit(HEART_RATE_FORGETTING)
+let fatigueState = {
+  level: FATIGUE_LEVEL.NORMAL,
+  score: 0,
+  speedTrend: 0,
+  heartRateDrift: 0,
+  ready: false
+}
+
+function elapsedMinutes(timestamp) {
+  return Math.max(0, (timestamp - startTime) / 60000)
+}
+
+function levelOf(score) {
+  let level = FATIGUE_LEVEL.NORMAL
+  LEVEL_THRESHOLDS.forEach((threshold, i) => {
+    if (score >= threshold) level = i + 1
+  })
+  return level
+}
+
+function updateFatigueState() {
+  const speedTrend = speedFit.count ? relativeSlope(speedFit) : 0
+  const heartRateDrift = heartRateFit.count ? relativeSlope(heartRateFit) : 0
+  const ready = speedFit.count >= MIN_STROKES &&
+    heartRateFit.count >= MIN_HEART_RATE_SAMPLES &&
+    Math.max(speedFit.lastX, heartRateFit.lastX) >= MIN_ELAPSED_MINUTES
+
+  // 心率上升而拍速不降多为热身，不计入疲劳
+  const speedDecay = Math.max(0, -speedTrend)
+  const score = ready && speedDecay > 0 ? speedDecay + HEART_RATE_DRIFT_WEIGHT * Math.max(0, heartRateDrift) : 0
+
+  fatigueState = {
+    level: ready ? levelOf(score) : FATIGUE_LEVEL.NORMAL,
+    score: Math.round(score * 10) / 10,
+    speedTrend: Math.round(speedTrend * 10) / 10,
+    heartRateDrift: Math.round(heartRateDrift * 10) / 10,
+    ready
+  }
+}
+
+/**
+ * 开始新一场的疲劳检测
+ * @param {number} sessionStartTime - 会话开始时间戳（毫秒）
+ */
+export function resetFatigue(sessionStartTime = Date.now()) {
+  startTime = sessionStartTime
+  speedFit = createLineFit(SPEED_FORGETTING)
+  heartRateFit = createLineFit(HEART_RATE_FORGETTING)
+  updateFatigueState()
+}
+
+/**
+ * 处理一次挥拍
+ * @param {{timestamp:number,speed:number}} stroke - strokeDetection 的挥拍事件
+ * @returns {Object} 当前疲劳状态
+ */
+export function processFatigueStroke(stroke) {
+  if (stroke && stroke.speed >= MIN_STROKE_SPEED) {
+    updateLineFit(speedFit, elapsedMinutes(stroke.timestamp || Date.now()), stroke.speed)
+    updateFatigueState()
+  }
+  return getFatigueState()
+}
+
+/**
+ * 处理一个心率采样
+ * @param {number} heartRate - 心率
+ * @param {number} timestamp - 采样时间戳（毫秒）
+ * @returns {Object} 当前疲劳状态
+ */
+export function processFatigueHeartRate(heartRate, timestamp = Date.now()) {
+  if (heartRate > 0) {
+    updateLineFit(heartRateFit, elapsedMinutes(timestamp), heartRate)
+    updateFatigueState()
+  }
+  return getFatigueState()
+}
+
+/**
+ * 获取当前疲劳状态
+ * @returns {{level:number,score:number,speedTrend:number,heartRateDrift:number,ready:boolean}}
+ *   speedTrend / heartRateDrift 为每 10 分钟变化的百分比；样本不足时 ready 为 false、等级为正常
+ */
+export function getFatigueState() {
+  return { ...fatigueState }
+}
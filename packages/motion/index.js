@@ -6,4 +6,6 @@
 export * from './sensor'
 export * from './heartRate'
 export * from './strokeDetection'
-export * from './calorieCalculation' 
\ No newline at end of file
+export * from './calorieCalculation'
+export * from './fatigue'
+export * from './liveStats'
\ No newline at end of file
@@ -0,0 +1,155 @@
+/**
+ * 实时统计快照模块
+ * 运动中的时长、心率、挥拍等字段写入一块挂在 global 上的定长缓冲（支持时为 SharedArrayBuffer），
+ * 快捷卡片与表盘组件按各自的刷新频率直接读取，不查数据库、不复制页面状态；
+ * 缓冲只在应用自身的 JS 上下文内可见，系统以独立进程运行的卡片/表盘读不到，
+ * 因此两个组件只能嵌入应用页面使用（运动面板的速览模式嵌入了表盘组件），未在 manifest 中注册为系统卡片或表盘；
+ * 读写以序列锁保护：写入前后各把序号加一（写入中为奇数），读取前后序号一致且为偶数才算完整的一份
+ */
+
+// 快照字段（Float64 槽位）
+export const LIVE_FIELD = {
+  STATE: 0,
+  START_TIME: 1,
+  ELAPSED_SECONDS: 2,
+  HEART_RATE: 3,
+  STROKES: 4,
+  SMASHES: 5,
+  MAX_SPEED: 6,
+  CALORIES: 7,
+  FATIGUE_LEVEL: 8,
+  UPDATED_AT: 9
+}
+
+// 会话状态
+export const LIVE_STATE = {
+  IDLE: 0,
+  RUNNING: 1
+}
+
+const FIELD_COUNT = 10
+// 头部 8 字节：序号（Int32）与布局版本（Int32），字段从 8 字节处开始，保证 Float64 对齐
+const HEADER_BYTES = 8
+const LAYOUT_VERSION = 1
+// 读取时遇到写入中的重试次数；同一 JS 上下文内读写不会交错，缓冲被其他线程共享时兜底
+const MAX_READ_RETRIES = 4
+
+// 发布时可传入的字段名 -> 槽位
+const FIELD_KEYS = {
+  elapsedSeconds: LIVE_FIELD.ELAPSED_SECONDS,
+  heartRate: LIVE_FIELD.HEART_RATE,
+  strokes: LIVE_FIELD.STROKES,
+  smashes: LIVE_FIELD.SMASHES,
+  maxSpeed: LIVE_FIELD.MAX_SPEED,
+  calories: LIVE_FIELD.CALORIES,
+  fatigueLevel: LIVE_FIELD.FATIGUE_LEVEL
+}
+const FIELD_NAMES = Object.keys(FIELD_KEYS)
+
+let views = null
+
+/**
+ * 取共享快照缓冲：整个应用只创建一次，页面、卡片与表盘拿到同一块内存
+ * @returns {{header:Int32Array,fields:Float64Array}} 缓冲视图
+ */
+function snapshotViews() {
+  let buffer = global.liveStatsBuffer
+  if (!buffer) {
+    const byteLength = HEADER_BYTES + FIELD_COUNT * 8
+    buffer = typeof SharedArrayBuffer === 'function' ? new SharedArrayBuffer(byteLength) : new ArrayBuffer(byteLength)
+    global.liveStatsBuffer = buffer
+  }
+  if (!views || views.buffer !== buffer) {
+    const header = new Int32Array(buffer, 0, 2)
+    header[1] = LAYOUT_VERSION
+    views = { buffer, header, fields: new Float64Array(buffer, HEADER_BYTES, FIELD_COUNT) }
+  }
+  return views
+}
+
+function beginWrite(header) {
+  header[0] = (header[0] + 1) | 0
+}
+
+function endWrite(header, fields) {
+  fields[LIVE_FIELD.UPDATED_AT] = Date.now()
+  header[0] = (header[0] + 1) | 0
+}
+
+/**
+ * 开始发布一场会话：清零全部字段并标记为运动中
+ * @param {number} startTime - 会话开始时间戳（毫秒）
+ */
+export function beginLiveSession(startTime = Date.now()) {
+  const { header, fields } = snapshotViews()
+  beginWrite(header)
+  fields.fill(0)
+  fields[LIVE_FIELD.STATE] = LIVE_STATE.RUNNING
+  fields[LIVE_FIELD.START_TIME] = startTime
+  endWrite(header, fields)
+}
+
+/**
+ * 发布一组字段，未传入的字段保持不变
+ * @param {{elapsedSeconds?:number,heartRate?:number,strokes?:number,smashes?:number,maxSpeed?:number,calories?:number,fatigueLevel?:number}} values - 字段值
+ */
+export function publishLiveStats(values) {
+  const { header, fields } = snapshotViews()
+  if (fields[LIVE_FIELD.STATE] !== LIVE_STATE.RUNNING) return
+
+  beginWrite(header)
+  for (let i = 0; i < FIELD_NAMES.length; i++) {
+    const value = values[FIELD_NAMES[i]]
+    if (value !== undefined) fields[FIELD_KEYS[FIELD_NAMES[i]]] = Number(value) || 0
+  }
+  endWrite(header, fields)
+}
+
+/**
+ * 结束发布：标记为空闲，读取方据此隐藏实时数据
+ */
+export function endLiveSession() {
+  const { header, fields } = snapshotViews()
+  beginWrite(header)
+  fields[LIVE_FIELD.STATE] = LIVE_STATE.IDLE
+  endWrite(header, fields)
+}
+
+/**
+ * 快照序号：未变化时读取方可跳过本次刷新
+ * @returns {number} 序号（写入中为奇数）
+ */
+export function getLiveVersion() {
+  return snapshotViews().header[0]
+}
+
+/**
+ * 读取一份完整的快照到调用方持有的对象中（不分配新对象）
+ * @param {Object} out - 输出对象，写入 state/startTime/elapsedSeconds/heartRate/strokes/smashes/maxSpeed/calories/fatigueLevel/updatedAt/version
+ * @returns {boolean} 读到完整快照且会话运动中时为 true
+ */
+export function readLiveStats(out) {
+  const { header, fields } = snapshotViews()
+
+  for (let attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+    const before = header[0]
+    if (before & 1) continue
+
+    out.state = fields[LIVE_FIELD.STATE]
+    out.startTime = fields[LIVE_FIELD.START_TIME]
+    out.elapsedSeconds = fields[LIVE_FIELD.ELAPSED_SECONDS]
+    out.heartRate = fields[LIVE_FIELD.HEART_RATE]
+    out.strokes = fields[LIVE_FIELD.STROKES]
+    out.smashes = fields[LIVE_FIELD.SMASHES]
+    out.maxSpeed = fields[LIVE_FIELD.MAX_SPEED]
+    out.calories = fields[LIVE_FIELD.CALORIES]
+    out.fatigueLevel = fields[LIVE_FIELD.FATIGUE_LEVEL]
+    out.updatedAt = fields[LIVE_FIELD.UPDATED_AT]
+
+    if (header[0] === before) {
+      out.version = before
+      return out.state === LIVE_STATE.RUNNING
+    }
+  }
+  return false
+}
@@ -19,7 +19,17 @@ const STROKE_CONFIG = {
   MIN_STROKE_DURATION: 150,
   
   // 两次挥拍之间的最小间隔（毫秒）
-  MIN_STROKE_INTERVAL: 500
+  MIN_STROKE_INTERVAL: 500,
+
+  // 超过该间隔未挥拍视为回合结束（毫秒）
+  RALLY_GAP: 4000
+}
+
+// 挥拍类型位标记，逐拍明细以其组合存储
+export const STROKE_FLAG = {
+  FOREHAND: 1,
+  BACKHAND: 2,
+  SMASH: 4
 }
 
 // 状态变量
@@ -34,6 +44,8 @@ let forehandCount = 0
 let backhandCount = 0
 let currentSpeed = 0
 let maxSpeed = 0
+let rallyId = 0
+let rallyEnded = true
 
 // 回调函数
 let onStrokeDetectedCallback = null
@@ -62,6 +74,15 @@ export function resetStats() {
   backhandCount = 0
   currentSpeed = 0
   maxSpeed = 0
+  rallyId = 0
+  rallyEnded = true
+}
+
+/**
+ * 标记当前回合结束（如计分时），下一拍开始新回合
+ */
+export function markRallyEnd() {
+  rallyEnded = true
 }
 
 /**
@@ -118,6 +139,12 @@ export function processGyroscopeData(gyroData) {
  */
 function completeStrokeDetection(currentTime) {
   isDetectingStroke = false
+
+  // 首拍、计分后或停顿过久时开始新回合
+  if (rallyEnded || currentTime - lastStrokeTime > STROKE_CONFIG.RALLY_GAP) {
+    rallyId++
+    rallyEnded = false
+  }
   lastStrokeTime = currentTime
   
   // 计算拍速 (简化模型，基于最大加速度)
@@ -154,6 +181,9 @@ function completeStrokeDetection(currentTime) {
     onStrokeDetectedCallback({
       timestamp: currentTime,
       speed: currentSpeed,
+      peakAcceleration: maxAcceleration,
+      rallyId,
+      type: (isForehand ? STROKE_FLAG.FOREHAND : STROKE_FLAG.BACKHAND) | (isSmash ? STROKE_FLAG.SMASH : 0),
       isSmash,
       isForehand
     })
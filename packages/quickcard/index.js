@@ -0,0 +1,7 @@
+/**
+ * 轻羽飞扬 - QuickCard 快捷卡片
+ * 运动中从实时快照（packages/motion/liveStats）读取时长、心率与挥拍数
+ * 快照只在应用进程内共享：组件需嵌入应用页面使用，注册为系统快捷卡片后读不到数据
+ */
+
+export * from './LiveStatsCard'
@@ -0,0 +1,296 @@
+/**
+ * 成就模块
+ * 规则按事件类型分组，挥拍/计时事件到来时只更新相关规则的内存状态（每条规则 O(1)），
+ * 达成即解锁并写入一行 achievements，不查询历史；
+ * 会话入库时在同一事务内把本场结果合并进持久化进度（累计类求和，单场类取最好成绩）
+ */
+import dbManager from '../core/utils/database'
+import { STROKE_FLAG } from '../motion/strokeDetection'
+
+export const ACHIEVEMENT_EVENT = {
+  STROKE: 'stroke',
+  TICK: 'tick',
+  SESSION: 'session'
+}
+
+// 单场类：进度为单场最好成绩；累计类：进度为历次会话之和
+const SCOPE = {
+  SESSION: 'session',
+  LIFETIME: 'lifetime'
+}
+
+function longestRally(strokeEvents) {
+  let longest = 0
+  let run = 0
+  let rally = null
+  ;(strokeEvents || []).forEach(stroke => {
+    run = stroke.rally && stroke.rally === rally ? run + 1 : 1
+    rally = stroke.rally
+    if (run > longest) longest = run
+  })
+  return longest
+}
+
+function fastestSmash(strokeEvents) {
+  return (strokeEvents || []).reduce((max, stroke) => (
+    stroke.type & STROKE_FLAG.SMASH && stroke.speed > max ? stroke.speed : max
+  ), 0)
+}
+
+/**
+ * 成就规则
+ * update(value, payload, aux) 由实时事件推进本场进度，返回新进度（aux 为规则自用的本场状态）；
+ * summarize(session) 由入库的会话数据计算本场进度，用于事务内合并持久化进度
+ */
+export const ACHIEVEMENT_RULES = [
+  {
+    id: 'first_session',
+    title: '首场',
+    description: '完成第一场运动',
+    scope: SCOPE.LIFETIME,
+    event: ACHIEVEMENT_EVENT.SESSION,
+    target: 1,
+    summarize: () => 1
+  },
+  {
+    id: 'sessions_50',
+    title: '坚持不懈',
+    description: '累计完成 50 场运动',
+    scope: SCOPE.LIFETIME,
+    event: ACHIEVEMENT_EVENT.SESSION,
+    target: 50,
+    summarize: () => 1
+  },
+  {
+    id: 'strokes_100',
+    title: '百拍',
+    description: '单场挥拍 100 次',
+    scope: SCOPE.SESSION,
+    event: ACHIEVEMENT_EVENT.STROKE,
+    target: 100,
+    update: value => value + 1,
+    summarize: session => session.strokes || 0
+  },
+  {
+    id: 'strokes_10000',
+    title: '万拍',
+    description: '累计挥拍 10000 次',
+    scope: SCOPE.LIFETIME,
+    event: ACHIEVEMENT_EVENT.STROKE,
+    target: 10000,
+    update: value => value + 1,
+    summarize: session => session.strokes || 0
+  },
+  {
+    id: 'long_play_30',
+    title: '渐入佳境',
+    description: '单场连续运动 30 分钟',
+    scope: SCOPE.SESSION,
+    event: ACHIEVEMENT_EVENT.TICK,
+    target: 30 * 60,
+    update: (value, payload) => Math.max(value, payload.elapsedSeconds || 0),
+    summarize: session => session.duration || 0
+  },
+  {
+    id: 'long_play_60',
+    title: '耐力王',
+    description: '单场连续运动 60 分钟',
+    scope: SCOPE.SESSION,
+    event: ACHIEVEMENT_EVENT.TICK,
+    target: 60 * 60,
+    update: (value, payload) => Math.max(value, payload.elapsedSeconds || 0),
+    summarize: session => session.duration || 0
+  },
+  {
+    id: 'rally_20',
+    title: '多拍相持',
+    description: '一个回合内挥拍 20 次',
+    scope: SCOPE.SESSION,
+    event: ACHIEVEMENT_EVENT.STROKE,
+    target: 20,
+    update: (value, payload, aux) => {
+      aux.run = payload.rallyId && payload.rallyId === aux.rally ? aux.run + 1 : 1
+      aux.rally = payload.rallyId
+      return Math.max(value, aux.run)
+    },
+    summarize: session => longestRally(session.strokeEvents)
+  },
+  {
+    id: 'smash_200',
+    title: '重炮手',
+    description: '杀球速度达到 200km/h',
+    scope: SCOPE.SESSION,
+    event: ACHIEVEMENT_EVENT.STROKE,
+    target: 200,
+    update: (value, payload) => (payload.type & STROKE_FLAG.SMASH ? Math.max(value, payload.speed || 0) : value),
+    summarize: session => fastestSmash(session.strokeEvents)
+  }
+]
+
+const RULES_BY_EVENT = ACHIEVEMENT_RULES.reduce((groups, rule) => {
+  groups[rule.event] = groups[rule.event] || []
+  if (rule.update) groups[rule.event].push(rule)
+  return groups
+}, {})
+
+const SELECT_STATE_SQL = 'SELECT id, progress, unlocked_at FROM achievements'
+const UNLOCK_SQL = `
+  INSERT INTO achievements (id, progress, unlocked_at) VALUES (?, 0, ?)
+  ON CONFLICT(id) DO UPDATE SET unlocked_at = COALESCE(unlocked_at, excluded.unlocked_at)
+`
+const MERGE_SQL = {
+  [SCOPE.LIFETIME]: `
+    INSERT INTO achievements (id, progress, unlocked_at)
+    VALUES (?, ?, CASE WHEN ? >= ? THEN ? END)
+    ON CONFLICT(id) DO UPDATE SET
+      unlocked_at = COALESCE(unlocked_at, CASE WHEN progress + excluded.progress >= ? THEN ? END),
+      progress = progress + excluded.progress
+  `,
+  [SCOPE.SESSION]: `
+    INSERT INTO achievements (id, progress, unlocked_at)
+    VALUES (?, ?, CASE WHEN ? >= ? THEN ? END)
+    ON CONFLICT(id) DO UPDATE SET
+      unlocked_at = COALESCE(unlocked_at, CASE WHEN excluded.progress >= ? THEN ? END),
+      progress = MAX(progress, excluded.progress)
+  `
+}
+
+// 持久化状态：id -> { progress, unlockedAt }
+const persisted = new Map()
+// 本场状态：id -> { value, aux, unlockedAt }，unlockedAt 为实时解锁时间，随会话入库事务写入
+let sessionState = new Map()
+let loadPromise = null
+
+function persistedOf(id) {
+  if (!persisted.has(id)) persisted.set(id, { progress: 0, unlockedAt: 0 })
+  return persisted.get(id)
+}
+
+function currentValue(rule, state) {
+  return rule.scope === SCOPE.LIFETIME ? persistedOf(rule.id).progress + state.value : state.value
+}
+
+/**
+ * 读取持久化的成就状态到内存，重复调用返回同一个 Promise
+ * @returns {Promise}
+ */
+export function loadAchievements() {
+  if (loadPromise) return loadPromise
+
+  loadPromise = dbManager.executeSql({ sql: SELECT_STATE_SQL })
+    .then(data => {
+      (data && data.rows ? data.rows : []).forEach(row => {
+        persisted.set(row.id, { progress: Number(row.progress) || 0, unlockedAt: row.unlocked_at || 0 })
+      })
+    })
+    .catch(err => {
+      console.error('读取成就状态失败:', err)
+      loadPromise = null
+    })
+
+  return loadPromise
+}
+
+/**
+ * 丢弃内存状态并重新读取
+ * @returns {Promise}
+ */
+export function reloadAchievements() {
+  persisted.clear()
+  loadPromise = null
+  return loadAchievements()
+}
+
+/**
+ * 开始新一场的实时评估（清空本场状态）
+ */
+export function beginAchievementSession() {
+  sessionState = new Map()
+}
+
+/**
+ * 处理一个实时事件，只推进订阅该事件的规则
+ * @param {string} event - ACHIEVEMENT_EVENT
+ * @param {Object} payload - 挥拍事件 {speed, type, rallyId} 或计时事件 {elapsedSeconds}
+ * @returns {Array<Object>} 本次新解锁的规则
+ */
+export function recordAchievementEvent(event, payload) {
+  const rules = RULES_BY_EVENT[event]
+  if (!rules || !rules.length) return []
+
+  const unlocked = []
+  const now = Date.now()
+
+  for (let i = 0; i < rules.length; i++) {
+    const rule = rules[i]
+    if (persistedOf(rule.id).unlockedAt) continue
+
+    let state = sessionState.get(rule.id)
+    if (!state) {
+      state = { value: 0, aux: {}, unlockedAt: 0 }
+      sessionState.set(rule.id, state)
+    }
+    if (state.unlockedAt) continue
+    state.value = rule.update(state.value, payload || {}, state.aux)
+
+    if (currentValue(rule, state) >= rule.target) {
+      // 只记在本场状态里，入库事务提交后才进入持久化状态
+      state.unlockedAt = now
+      unlocked.push(rule)
+    }
+  }
+
+  return unlocked
+}
+
+/**
+ * 在会话入库事务内写入本场实时解锁并合并本场结果到持久化进度，提交后重新载入内存状态
+ * @param {Object} tx - 事务上下文
+ * @param {Object} session - 会话数据
+ * @returns {Promise}
+ */
+export function applySessionAchievements(tx, session) {
+  const now = Date.now()
+  const results = ACHIEVEMENT_RULES.map(rule => {
+    const value = Number(rule.summarize(session)) || 0
+    // 单场类取会话数据与实时进度中较好的一个（如回合数只在实时事件中完整）
+    const live = rule.scope === SCOPE.SESSION && sessionState.has(rule.id) ? sessionState.get(rule.id).value : 0
+    return { rule, value: Math.max(value, live) }
+  })
+
+  // 提交后重新读取（只有几行），本场进度已并入持久化进度，清空以免累计类重复计数
+  tx.afterCommit(() => {
+    sessionState = new Map()
+    return reloadAchievements()
+  })
+
+  // 实时解锁保留解锁时刻，先于合并写入
+  const unlocks = []
+  sessionState.forEach((state, id) => {
+    if (state.unlockedAt) unlocks.push({ sql: UNLOCK_SQL, args: [id, state.unlockedAt] })
+  })
+  const merges = results.map(({ rule, value }) => ({
+    sql: MERGE_SQL[rule.scope],
+    args: [rule.id, value, value, rule.target, now, rule.target, now]
+  }))
+
+  return unlocks.concat(merges).reduce((chain, query) => chain.then(() => tx.executeSql(query)), Promise.resolve())
+}
+
+/**
+ * 读取全部成就及进度
+ * @returns {Promise<Array<{id:string,title:string,description:string,target:number,progress:number,unlockedAt:number}>>} 成就列表
+ */
+export function getAchievements() {
+  return loadAchievements().then(() => ACHIEVEMENT_RULES.map(rule => {
+    const record = persistedOf(rule.id)
+    return {
+      id: rule.id,
+      title: rule.title,
+      description: rule.description,
+      target: rule.target,
+      progress: Math.min(rule.target, record.progress),
+      unlockedAt: record.unlockedAt
+    }
+  }))
+}
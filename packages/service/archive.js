@@ -0,0 +1,121 @@
+/**
+ * 会话归档模块
+ * 每个会话一个 FSAR 二进制文件，Report 按偏移读取并直接在字节上绘制
+ */
+import { FILES_DIR, ensureDir, readBytes, writeBytes, removeFile, moveFile, removeDir } from '../core/utils/file'
+import {
+  ARCHIVE_BLOCK,
+  archivePrefixSize,
+  decodeArchiveHeader,
+  emptyColumnarSeries,
+  encodeSessionArchive,
+  viewSeriesBlock
+} from '../core/utils/sessionArchive'
+
+export const ARCHIVE_DIR = `${FILES_DIR}sessions/`
+
+let dirReady = null
+
+function ensureArchiveDir() {
+  if (!dirReady) {
+    dirReady = ensureDir(ARCHIVE_DIR)
+  }
+  return dirReady
+}
+
+/**
+ * 会话归档文件 uri
+ * @param {number} sessionId - 会话ID
+ * @returns {string} 文件 uri
+ */
+export function archiveUri(sessionId) {
+  return `${ARCHIVE_DIR}${sessionId}.fsar`
+}
+
+function archiveTempUri(sessionId) {
+  return `${archiveUri(sessionId)}.tmp`
+}
+
+/**
+ * 写入会话归档：先写临时文件再替换，重写（如降采样后）更小的归档时旧文件的空间随之释放
+ * @param {number} sessionId - 会话ID
+ * @param {Object} session - 会话数据（序列为 [{t, v}]）
+ * @returns {Promise}
+ */
+export function writeSessionArchive(sessionId, session) {
+  if (!sessionId || !session) return Promise.resolve()
+
+  const uri = archiveUri(sessionId)
+  const tempUri = archiveTempUri(sessionId)
+  return ensureArchiveDir()
+    .then(() => removeFile(tempUri))
+    .then(() => writeBytes(tempUri, encodeSessionArchive(session)))
+    // 先删旧文件再改名：中途断电时读取会回退到完整的临时文件
+    .then(() => removeFile(uri))
+    .then(() => moveFile(tempUri, uri))
+}
+
+/**
+ * 读取会话归档：先定长读取头部与索引，再一次读取全部数据块
+ * @param {number} sessionId - 会话ID
+ * @returns {Promise<{startTime:number,endTime:number,summary:Object,heartRate:Object,speed:Object}|null>} 归档内容，不存在或格式不符时为 null
+ */
+export function readSessionArchive(sessionId) {
+  return readArchiveFile(archiveUri(sessionId))
+    .then(result => result || readArchiveFile(archiveTempUri(sessionId)))
+}
+
+function readArchiveFile(uri) {
+  return readBytes(uri, 0, archivePrefixSize())
+    .then(prefix => {
+      const header = decodeArchiveHeader(prefix)
+      if (!header) return null
+
+      const blocks = header.blocks.filter(block => block.count > 0)
+      const result = {
+        startTime: header.startTime,
+        endTime: header.endTime,
+        summary: header.summary,
+        heartRate: emptyColumnarSeries(header.startTime),
+        speed: emptyColumnarSeries(header.startTime)
+      }
+      if (!blocks.length) return result
+
+      const start = Math.min(...blocks.map(block => block.offset))
+      const end = Math.max(...blocks.map(block => block.offset + block.byteLength))
+
+      return readBytes(uri, start, end - start)
+        .then(bytes => {
+          blocks.forEach(block => {
+            const series = viewSeriesBlock(
+              bytes.subarray(block.offset - start, block.offset - start + block.byteLength),
+              block.count,
+              header.startTime
+            )
+            if (block.blockId === ARCHIVE_BLOCK.HEART_RATE) result.heartRate = series
+            if (block.blockId === ARCHIVE_BLOCK.SPEED) result.speed = series
+          })
+          return result
+        })
+    })
+    .catch(() => null)
+}
+
+/**
+ * 删除会话归档
+ * @param {number} sessionId - 会话ID
+ * @returns {Promise}
+ */
+export function removeSessionArchive(sessionId) {
+  return removeFile(archiveTempUri(sessionId))
+    .then(() => removeFile(archiveUri(sessionId)))
+}
+
+/**
+ * 删除全部会话归档
+ * @returns {Promise}
+ */
+export function clearSessionArchives() {
+  dirReady = null
+  return removeDir(ARCHIVE_DIR)
+}
@@ -0,0 +1,220 @@
+/**
+ * 备份与恢复模块
+ * 全部历史流式导出为 tar 归档（每个会话一个条目，默认为 FastLZ 压缩的 JSON），
+ * 导出按游标逐页读取、逐条目追加写入，导入按偏移逐条目读取，内存占用与历史总量无关
+ */
+import dbManager from '../core/utils/database'
+import { FILES_DIR, ensureDir, readBytes, writeBytes, removeFile, listFiles } from '../core/utils/file'
+import { compress, decompress } from '../core/utils/fastlz'
+import { TAR_BLOCK_SIZE, tarPadding, encodeTarHeader, decodeTarHeader } from '../core/utils/tar'
+import { encodeUtf8, decodeUtf8 } from '../core/utils/utf8'
+import { formatTimestamp } from '../core/utils/dateTime'
+import { insertSession, parseSeries } from './storage'
+import { ensureRollups } from './rollups'
+import { getStrokesInRange } from './strokes'
+
+export const BACKUP_DIR = `${FILES_DIR}backup/`
+
+const BACKUP_FORMAT_VERSION = 1
+const SESSION_ENTRY_DIR = 'sessions/'
+// 压缩条目后缀（默认）：条目为不带头部、不含原始长度的 FastLZ level 1 裸数据块，只有本应用能解开，
+// 系统的 @blueos.util.fastlz 与桌面工具都不识别；需要外部工具读取时以 compress: false 导出纯 JSON
+const COMPRESSED_SUFFIX = '.json.lz'
+const PLAIN_SUFFIX = '.json'
+// 每页读取的会话数，决定导出时的内存上限
+const EXPORT_PAGE_SIZE = 4
+
+const EXPORT_FIRST_PAGE_SQL = 'SELECT * FROM sessions ORDER BY start_time ASC, id ASC LIMIT ?'
+const EXPORT_AFTER_CURSOR_SQL = `
+  SELECT * FROM sessions
+  WHERE (start_time, id) > (?, ?)
+  ORDER BY start_time ASC, id ASC LIMIT ?
+`
+const SESSION_EXISTS_SQL = 'SELECT id FROM sessions WHERE start_time = ? LIMIT 1'
+
+function parseJson(payload, fallback) {
+  if (!payload) return fallback
+  if (typeof payload === 'object') return payload
+  try {
+    return JSON.parse(payload)
+  } catch (e) {
+    return fallback
+  }
+}
+
+function throughput(bytes, startedAt) {
+  const ms = Math.max(1, Date.now() - startedAt)
+  return { ms, bytesPerSecond: Math.round(bytes * 1000 / ms) }
+}
+
+function buildEntry(name, payload, compressed) {
+  const data = compressed ? compress(payload) : payload
+  const header = encodeTarHeader(name, data.length)
+  const entry = new Uint8Array(TAR_BLOCK_SIZE + data.length + tarPadding(data.length))
+  entry.set(header, 0)
+  entry.set(data, TAR_BLOCK_SIZE)
+  return entry
+}
+
+/**
+ * 会话行转为导入用的会话数据
+ * @param {Object} record - 导出的会话行（含 strokes）
+ * @returns {Object} 会话数据
+ */
+function toImportSession(record) {
+  return {
+    mode: record.mode,
+    startTime: record.start_time,
+    endTime: record.end_time,
+    duration: record.duration,
+    calories: record.calories,
+    maxSpeed: record.max_speed,
+    avgHeartRate: record.avg_heart_rate,
+    maxHeartRate: record.max_heart_rate,
+    minHeartRate: record.min_heart_rate,
+    strokes: record.strokes,
+    smashes: record.smashes,
+    forehand: record.forehand,
+    backhand: record.backhand,
+    fatigueLevel: record.fatigue_level,
+    fatigueScore: record.fatigue_score,
+    notes: record.notes,
+    heartRateSeries: parseSeries(record.heart_rate_series),
+    speedSeries: parseSeries(record.speed_series),
+    scoreboard: parseJson(record.scoreboard, null),
+    heartRateWarningEvents: parseJson(record.heart_rate_warning_events, []),
+    strokeEvents: Array.isArray(record.strokeEvents) ? record.strokeEvents : []
+  }
+}
+
+function readExportPage(cursor) {
+  const query = cursor
+    ? { sql: EXPORT_AFTER_CURSOR_SQL, args: [cursor.startTime, cursor.id, EXPORT_PAGE_SIZE] }
+    : { sql: EXPORT_FIRST_PAGE_SQL, args: [EXPORT_PAGE_SIZE] }
+
+  return dbManager.executeSql(query)
+    .then(data => (data && data.rows ? data.rows : []))
+}
+
+/**
+ * 导出全部历史为 tar 归档
+ * @param {{compress?:boolean,onProgress?:Function}} options - 默认条目为应用私有的 FastLZ 裸数据块，compress 为 false 时为纯 JSON；onProgress 每写入一页回调 {sessions, bytes}
+ * @returns {Promise<{uri:string,sessions:number,bytes:number,ms:number,bytesPerSecond:number}>} 导出结果与吞吐
+ */
+export function exportHistory(options = {}) {
+  const compressed = options.compress !== false
+  const suffix = compressed ? COMPRESSED_SUFFIX : PLAIN_SUFFIX
+  const uri = `${BACKUP_DIR}feathersoar-${formatTimestamp(Date.now(), 'YYYYMMDD-HHmmss')}.tar`
+  const startedAt = Date.now()
+  const stats = { sessions: 0, bytes: 0, rawBytes: 0 }
+
+  const append = bytes => writeBytes(uri, bytes, { append: true })
+    .then(() => {
+      stats.bytes += bytes.length
+    })
+
+  const exportPage = cursor => readExportPage(cursor)
+    .then(rows => {
+      if (!rows.length) return null
+
+      return rows.reduce((chain, row) => chain.then(() => getStrokesInRange(row.id)
+        .then(strokes => {
+          const payload = encodeUtf8(JSON.stringify({ ...row, strokeEvents: strokes }))
+          stats.rawBytes += payload.length
+          stats.sessions++
+          return append(buildEntry(`${SESSION_ENTRY_DIR}${row.start_time}-${row.id}${suffix}`, payload, compressed))
+        })), Promise.resolve())
+        .then(() => {
+          if (typeof options.onProgress === 'function') {
+            options.onProgress({ sessions: stats.sessions, bytes: stats.bytes })
+          }
+          const last = rows[rows.length - 1]
+          return rows.length < EXPORT_PAGE_SIZE ? null : exportPage({ startTime: last.start_time, id: last.id })
+        })
+    })
+
+  return ensureDir(BACKUP_DIR)
+    .then(() => removeFile(uri))
+    .then(() => exportPage(null))
+    .then(() => {
+      const manifest = encodeUtf8(JSON.stringify({
+        app: 'feathersoar',
+        version: BACKUP_FORMAT_VERSION,
+        compression: compressed ? 'fastlz1' : 'none',
+        sessions: stats.sessions,
+        createdAt: startedAt
+      }))
+      // 清单放在最后：会话数在导出结束时才确定
+      return append(buildEntry('manifest.json', manifest, false))
+    })
+    .then(() => append(new Uint8Array(TAR_BLOCK_SIZE * 2)))
+    .then(() => {
+      const result = { uri, sessions: stats.sessions, bytes: stats.bytes, ...throughput(stats.rawBytes, startedAt) }
+      console.log(`导出完成: ${result.sessions} 个会话, 原始 ${Math.round(stats.rawBytes / 1024)}KB -> 归档 ${Math.round(stats.bytes / 1024)}KB, ${result.ms}ms, ${Math.round(result.bytesPerSecond / 1024)}KB/s`)
+      return result
+    })
+}
+
+/**
+ * 从 tar 归档导入历史；开始时间已存在的会话跳过
+ * @param {string} uri - 归档 uri
+ * @param {{onProgress?:Function}} options - onProgress 每导入一个条目回调 {sessions, skipped, bytes}
+ * @returns {Promise<{sessions:number,skipped:number,bytes:number,ms:number,bytesPerSecond:number}>} 导入结果与吞吐
+ */
+export function importHistory(uri, options = {}) {
+  const startedAt = Date.now()
+  const stats = { sessions: 0, skipped: 0, bytes: 0 }
+
+  const importSession = record => dbManager.executeSql({ sql: SESSION_EXISTS_SQL, args: [record.start_time] })
+    .then(data => {
+      if (data && data.rows && data.rows.length) {
+        stats.skipped++
+        return null
+      }
+      stats.sessions++
+      // 恢复的是已计入过成就的历史会话，不再重复累计
+      return dbManager.transaction(tx => insertSession(tx, toImportSession(record), { achievements: false }))
+    })
+
+  const readEntry = position => readBytes(uri, position, TAR_BLOCK_SIZE)
+    .then(header => {
+      const entry = decodeTarHeader(header)
+      if (!entry) return null
+
+      const next = position + TAR_BLOCK_SIZE + entry.size + tarPadding(entry.size)
+      const isSession = entry.type === '0' && entry.name.indexOf(SESSION_ENTRY_DIR) === 0
+      if (!isSession || !entry.size) return readEntry(next)
+
+      return readBytes(uri, position + TAR_BLOCK_SIZE, entry.size)
+        .then(data => {
+          stats.bytes += TAR_BLOCK_SIZE + data.length
+          const payload = entry.name.slice(-COMPRESSED_SUFFIX.length) === COMPRESSED_SUFFIX ? decompress(data) : data
+          return importSession(JSON.parse(decodeUtf8(payload)))
+        })
+        .then(() => {
+          if (typeof options.onProgress === 'function') {
+            options.onProgress({ sessions: stats.sessions, skipped: stats.skipped, bytes: stats.bytes })
+          }
+          return readEntry(next)
+        })
+    })
+
+  return ensureRollups()
+    .then(() => readEntry(0))
+    .then(() => {
+      const result = { ...stats, ...throughput(stats.bytes, startedAt) }
+      console.log(`导入完成: ${result.sessions} 个会话, 跳过 ${result.skipped} 个, ${result.ms}ms, ${Math.round(result.bytesPerSecond / 1024)}KB/s`)
+      return result
+    })
+}
+
+/**
+ * 列出备份归档，最新的在前
+ * @returns {Promise<Array<{uri:string,length:number,lastModifiedTime:number}>>} 备份列表
+ */
+export function listBackups() {
+  return listFiles(BACKUP_DIR)
+    .then(files => files
+      .filter(file => /\.tar$/.test(file.uri))
+      .sort((a, b) => (b.uri > a.uri ? 1 : -1)))
+}
@@ -0,0 +1,93 @@
+/**
+ * 训练日历模块
+ * 一年的每日运动分钟与训练负荷由日汇总一次区间读取（主键 period, period_start 范围扫描）得到，
+ * 按周列、周一至周日行排布为定长数组，热力等级在此处算好，页面只需一遍绘制
+ */
+import { getRollups } from './rollups'
+
+const DAY_MS = 24 * 60 * 60 * 1000
+// 日历列数：53 周覆盖任意 365 天
+export const CALENDAR_WEEKS = 53
+// 热力等级数（0 为无运动）
+export const CALENDAR_LEVELS = 5
+// 负荷以 100bpm 为基准：心率加权分钟 / 100，无心率的会话按时长计
+const LOAD_REFERENCE_HEART_RATE = 100
+
+function addDays(timestamp, days) {
+  const date = new Date(timestamp)
+  date.setDate(date.getDate() + days)
+  return date.getTime()
+}
+
+/**
+ * 日历首格（本地时间周一零点）：最后一列为 now 所在的周
+ * @param {number} now - 当前时间戳（毫秒）
+ * @param {number} weeks - 列数
+ * @returns {number} 首格零点时间戳
+ */
+function calendarStart(now, weeks) {
+  const monday = new Date(now)
+  monday.setHours(0, 0, 0, 0)
+  monday.setDate(monday.getDate() - ((monday.getDay() || 7) - 1))
+  return addDays(monday.getTime(), -7 * (weeks - 1))
+}
+
+/**
+ * 读取训练日历
+ * @param {number} now - 当前时间戳（毫秒），决定最后一列
+ * @param {number} weeks - 列数，默认 CALENDAR_WEEKS
+ * @returns {Promise<{start:number,days:number,today:number,minutes:Float32Array,load:Float32Array,levels:Uint8Array,maxMinutes:number,activeDays:number,totalMinutes:number,totalLoad:number}>}
+ *   start 为首格零点，第 i 格为 start 之后第 i 天（列 = floor(i / 7)，行 = i % 7，周一为 0）；today 为今天所在格
+ */
+export function getTrainingCalendar(now = Date.now(), weeks = CALENDAR_WEEKS) {
+  const start = calendarStart(now, weeks)
+  const days = weeks * 7
+  const minutes = new Float32Array(days)
+  const load = new Float32Array(days)
+  const levels = new Uint8Array(days)
+  const calendar = {
+    start,
+    days,
+    today: Math.round((new Date(now).setHours(0, 0, 0, 0) - start) / DAY_MS),
+    minutes,
+    load,
+    levels,
+    maxMinutes: 0,
+    activeDays: 0,
+    totalMinutes: 0,
+    totalLoad: 0
+  }
+
+  return getRollups('day', start, addDays(start, days))
+    .then(rows => {
+      rows.forEach(row => {
+        // 夏令时切换日不足或超过 24 小时，取整即可定位
+        const index = Math.round((row.period_start - start) / DAY_MS)
+        if (index < 0 || index >= days) return
+
+        const dayMinutes = (row.total_duration || 0) / 60
+        const weighted = (row.heart_rate_weighted || 0) / 60 / LOAD_REFERENCE_HEART_RATE
+        minutes[index] = dayMinutes
+        load[index] = weighted > 0 ? weighted : dayMinutes
+
+        calendar.totalMinutes += dayMinutes
+        calendar.totalLoad += load[index]
+        if (dayMinutes > calendar.maxMinutes) calendar.maxMinutes = dayMinutes
+        if (row.session_count > 0) calendar.activeDays++
+      })
+
+      // 按当年最长运动日等分等级，有运动的日子至少为 1 级
+      const scale = calendar.maxMinutes > 0 ? (CALENDAR_LEVELS - 1) / calendar.maxMinutes : 0
+      for (let i = 0; i < days; i++) {
+        if (minutes[i] > 0) levels[i] = Math.max(1, Math.ceil(minutes[i] * scale))
+      }
+
+      calendar.totalMinutes = Math.round(calendar.totalMinutes)
+      calendar.totalLoad = Math.round(calendar.totalLoad)
+      return calendar
+    })
+    .catch(err => {
+      console.error('读取训练日历失败:', err)
+      return calendar
+    })
+}
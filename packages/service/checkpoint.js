@@ -0,0 +1,266 @@
+/**
+ * 会话检查点模块
+ * 运动过程中定期把增量数据追加写入 session_checkpoints，
+ * 应用崩溃或设备重启后可在下次启动时重建未结束的会话
+ */
+import dbManager from '../core/utils/database'
+import { insertSession } from './storage'
+import { ensureRollups } from './rollups'
+import {
+  MATCH_SIDE,
+  createMatch,
+  decodeMatchRecord,
+  exportMatchScoreboard
+} from '../core/utils/matchEngine'
+
+// 检查点记录类型
+export const CHECKPOINT_KIND = {
+  START: 'start',
+  SUMMARY: 'summary',
+  HEART_RATE: 'hr',
+  SPEED: 'speed',
+  WARNING: 'warning',
+  SCORE: 'score',
+  STROKE: 'stroke'
+}
+
+// 计分检查点的操作码（存于 v 列），恢复时按顺序重放到比赛引擎
+export const SCORE_ACTION = {
+  HOME: 0,
+  AWAY: 1,
+  UNDO: 2,
+  REDO: 3,
+  RESET: 4
+}
+
+// 每条 INSERT 的最大行数（5 个参数/行，低于 SQLite 默认 999 个参数上限）
+const ROWS_PER_INSERT = 150
+
+const CHECKPOINT_ROW_PLACEHOLDER = '(?, ?, ?, ?, ?)'
+const CHECKPOINT_INSERT_PREFIX = 'INSERT INTO session_checkpoints (session_key, kind, t, v, payload) VALUES '
+const CHECKPOINT_ROWS_SQL = 'SELECT kind, t, v, payload FROM session_checkpoints WHERE session_key = ? ORDER BY seq ASC'
+const CHECKPOINT_KEYS_SQL = 'SELECT DISTINCT session_key FROM session_checkpoints'
+const CHECKPOINT_DELETE_SQL = 'DELETE FROM session_checkpoints WHERE session_key = ?'
+
+/**
+ * 创建一条检查点记录
+ * @param {string} kind - 记录类型，见 CHECKPOINT_KIND
+ * @param {number} t - 时间戳（毫秒）
+ * @param {number|null} v - 数值
+ * @param {Object|null} payload - 附加数据，序列化为 JSON
+ * @returns {Array} 检查点记录
+ */
+export function createCheckpointRecord(kind, t, v = null, payload = null) {
+  return [kind, t, v, payload ? JSON.stringify(payload) : null]
+}
+
+function parsePayload(payload) {
+  if (!payload) return null
+  try {
+    return JSON.parse(payload)
+  } catch (e) {
+    // 断电可能留下残缺记录，跳过即可
+    console.error('解析检查点失败:', e)
+    return null
+  }
+}
+
+function appendRecords(tx, sessionKey, records) {
+  let chain = Promise.resolve()
+
+  for (let i = 0; i < records.length; i += ROWS_PER_INSERT) {
+    const chunk = records.slice(i, i + ROWS_PER_INSERT)
+    const args = []
+    chunk.forEach(record => {
+      args.push(sessionKey, record[0], record[1], record[2], record[3])
+    })
+    const sql = CHECKPOINT_INSERT_PREFIX + chunk.map(() => CHECKPOINT_ROW_PLACEHOLDER).join(', ')
+    chain = chain.then(() => tx.executeSql({ sql, args }))
+  }
+
+  return chain
+}
+
+/**
+ * 开始记录会话检查点
+ * @param {Object} session - 会话数据（createSession 的返回值）
+ * @returns {Promise}
+ */
+export function beginCheckpoint(session) {
+  const sessionKey = session.startTime
+  const start = createCheckpointRecord(CHECKPOINT_KIND.START, sessionKey, null, {
+    mode: session.mode,
+    startTime: session.startTime,
+    scoreboard: session.scoreboard || null
+  })
+
+  return dbManager.transaction(tx => {
+    return tx.executeSql({ sql: CHECKPOINT_DELETE_SQL, args: [sessionKey] })
+      .then(() => appendRecords(tx, sessionKey, [start]))
+  })
+}
+
+/**
+ * 追加一批检查点记录，一次事务内顺序写入
+ * @param {number} sessionKey - 会话键（开始时间戳）
+ * @param {Array} records - createCheckpointRecord 生成的记录
+ * @returns {Promise}
+ */
+export function appendCheckpoint(sessionKey, records) {
+  if (!records || !records.length) return Promise.resolve()
+  return dbManager.transaction(tx => appendRecords(tx, sessionKey, records))
+}
+
+function applyScoreAction(match, action) {
+  switch (action) {
+    case SCORE_ACTION.HOME:
+      match.point(MATCH_SIDE.HOME)
+      break
+    case SCORE_ACTION.AWAY:
+      match.point(MATCH_SIDE.AWAY)
+      break
+    case SCORE_ACTION.UNDO:
+      match.undo()
+      break
+    case SCORE_ACTION.REDO:
+      match.redo()
+      break
+    case SCORE_ACTION.RESET:
+      match.reset()
+      break
+    default:
+      break
+  }
+}
+
+/**
+ * 由检查点记录重建会话
+ * @param {Array} rows - 按写入顺序排列的检查点行
+ * @returns {Object|null} 会话数据
+ */
+function rebuildSession(rows) {
+  let session = null
+  const heartRateSeries = []
+  const speedSeries = []
+  const heartRateWarningEvents = []
+  const strokeEvents = []
+  let match = null
+  let lastT = 0
+
+  rows.forEach(row => {
+    const payload = parsePayload(row.payload)
+    lastT = Math.max(lastT, row.t || 0)
+
+    switch (row.kind) {
+      case CHECKPOINT_KIND.START:
+        session = payload ? { ...payload } : null
+        match = session && session.scoreboard
+          ? decodeMatchRecord(session.scoreboard.record) || createMatch(session.scoreboard.rules)
+          : null
+        break
+      case CHECKPOINT_KIND.SUMMARY:
+        if (session && payload) Object.assign(session, payload)
+        break
+      case CHECKPOINT_KIND.HEART_RATE:
+        heartRateSeries.push({ t: row.t, v: row.v })
+        break
+      case CHECKPOINT_KIND.SPEED:
+        speedSeries.push({ t: row.t, v: row.v })
+        break
+      case CHECKPOINT_KIND.WARNING:
+        heartRateWarningEvents.push({ t: row.t, type: payload && payload.type, value: row.v })
+        break
+      case CHECKPOINT_KIND.STROKE:
+        // payload 为 [type, peakAcceleration, rally]，v 为拍速
+        if (Array.isArray(payload)) {
+          strokeEvents.push({ t: row.t, type: payload[0], speed: row.v, peakAcceleration: payload[1], rally: payload[2] })
+        }
+        break
+      case CHECKPOINT_KIND.SCORE:
+        // v 为 SCORE_ACTION，逐条重放得到结束时的比分与逐分记录
+        if (match) applyScoreAction(match, row.v)
+        break
+      default:
+        break
+    }
+  })
+
+  if (!session) return null
+
+  if (match) session.scoreboard = exportMatchScoreboard(match, session.scoreboard.enabled)
+  session.endTime = session.endTime || lastT
+  session.heartRateSeries = heartRateSeries
+  session.speedSeries = speedSeries
+  session.heartRateWarningEvents = heartRateWarningEvents
+  session.strokeEvents = strokeEvents
+  return session
+}
+
+/**
+ * 没有任何序列点且时长为 0 的会话（开始后几秒内被杀掉），不值得入库
+ * @param {Object} session - rebuildSession 的结果
+ * @returns {boolean}
+ */
+function isEmptySession(session) {
+  return !session.heartRateSeries.length && !session.speedSeries.length &&
+    !session.strokeEvents.length && !(Number(session.duration) > 0)
+}
+
+function readSeries(tx, sessionKey) {
+  return tx.executeSql({ sql: CHECKPOINT_ROWS_SQL, args: [sessionKey] })
+    .then(data => rebuildSession(data && data.rows ? data.rows : []))
+}
+
+/**
+ * 结束会话：用已落盘的检查点序列提交会话，并清除检查点
+ * @param {number} sessionKey - 会话键（开始时间戳）
+ * @param {Object} session - 结束时的会话汇总（时长、卡路里、计数等）
+ * @returns {Promise<number>} 新会话ID
+ */
+export function commitCheckpoint(sessionKey, session) {
+  return ensureRollups()
+    .then(() => dbManager.transaction(tx => {
+      return readSeries(tx, sessionKey)
+        .then(recovered => {
+          const merged = {
+            ...session,
+            heartRateSeries: recovered ? recovered.heartRateSeries : session.heartRateSeries,
+            speedSeries: recovered ? recovered.speedSeries : session.speedSeries,
+            strokeEvents: recovered ? recovered.strokeEvents : session.strokeEvents
+          }
+          return insertSession(tx, merged)
+        })
+        .then(insertId => tx.executeSql({ sql: CHECKPOINT_DELETE_SQL, args: [sessionKey] })
+          .then(() => insertId))
+    }))
+}
+
+/**
+ * 恢复上次未正常结束的会话并入库
+ * @returns {Promise<Array<number>>} 恢复出的会话ID
+ */
+export function recoverUnfinishedSessions() {
+  return dbManager.executeSql({ sql: CHECKPOINT_KEYS_SQL })
+    .then(data => {
+      const keys = (data && data.rows ? data.rows : []).map(row => row.session_key)
+      if (!keys.length) return []
+
+      return ensureRollups().then(() => keys.reduce((chain, sessionKey) => chain.then(ids => {
+        return dbManager.transaction(tx => {
+          return readSeries(tx, sessionKey)
+            // 空会话只清除检查点，不计入汇总、个人最佳与成就
+            .then(session => (session && !isEmptySession(session) ? insertSession(tx, session) : 0))
+            .then(insertId => tx.executeSql({ sql: CHECKPOINT_DELETE_SQL, args: [sessionKey] })
+              .then(() => insertId))
+        })
+        .then(insertId => {
+          console.log('已恢复未结束的会话', sessionKey, insertId)
+          return insertId ? ids.concat(insertId) : ids
+        })
+      }), Promise.resolve([])))
+    })
+    .catch(err => {
+      console.error('恢复未结束会话失败:', err)
+      return []
+    })
+}
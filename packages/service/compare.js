@@ -0,0 +1,338 @@
+/**
+ * 会话对比模块
+ * 两个会话的心率/拍速曲线按运动时长或回合序号对齐后逐段求差：
+ * 序列直接取自 FSAR 归档的类型化数组视图，单次顺序扫描分桶，不展开为 {t, v} 对象数组；
+ * 拍速分布取会话直方图（按箱有序，双指针归并），击球构成与回合节奏由 SQL 聚合得到
+ */
+import dbManager from '../core/utils/database'
+import { HISTOGRAM_METRIC, histogramQuantiles } from '../core/utils/histogram'
+import { toColumnarSeries } from '../core/utils/sessionArchive'
+import { STROKE_FLAG } from '../motion/strokeDetection'
+import { readSessionArchive, writeSessionArchive } from './archive'
+import { getSessionById, getSessionSummaryById, toArchiveSession } from './storage'
+
+export const COMPARE_ALIGN = {
+  ELAPSED: 'elapsed',
+  RALLY: 'rally'
+}
+
+// 按时长对齐时的最大分段数与最小分段长度（毫秒）
+const COMPARE_MAX_BUCKETS = 240
+const COMPARE_MIN_STEP = 1000
+
+const HISTOGRAM_BY_SESSION_SQL = `
+  SELECT bin, count FROM session_histograms
+  WHERE session_id = ? AND metric = ?
+  ORDER BY bin ASC
+`
+const STROKE_MIX_SQL = `
+  SELECT type, COUNT(*) AS n, SUM(speed) AS speed_sum FROM session_strokes
+  WHERE session_id = ?
+  GROUP BY type
+`
+const RALLY_WINDOWS_SQL = `
+  SELECT COUNT(*) AS n, MIN(t) AS first_t, MAX(t) AS last_t FROM session_strokes
+  WHERE session_id = ? AND rally > 0
+  GROUP BY rally
+  ORDER BY first_t ASC
+`
+
+const PREVIOUS_SESSION_SQL = `
+  SELECT id FROM sessions
+  WHERE start_time < (SELECT start_time FROM sessions WHERE id = ?)
+  ORDER BY start_time DESC LIMIT 1
+`
+
+/**
+ * 读取会话汇总与列式序列；旧会话没有归档时解析一次 JSON 并补写归档
+ * @param {number} sessionId - 会话ID
+ * @returns {Promise<{summary:Object,startTime:number,heartRate:Object,speed:Object}>}
+ */
+function loadColumnarSession(sessionId) {
+  return Promise.all([getSessionSummaryById(sessionId), readSessionArchive(sessionId)])
+    .then(([summary, archive]) => {
+      if (archive) {
+        return { summary, startTime: archive.startTime, heartRate: archive.heartRate, speed: archive.speed }
+      }
+
+      return getSessionById(sessionId)
+        .then(session => {
+          writeSessionArchive(sessionId, toArchiveSession(session))
+            .catch(err => console.error('补写会话归档失败:', err))
+          const startTime = session.start_time || 0
+          return {
+            summary,
+            startTime,
+            heartRate: toColumnarSeries(session.heartRateSeries, startTime),
+            speed: toColumnarSeries(session.speedSeries, startTime)
+          }
+        })
+    })
+}
+
+/**
+ * 读取回合窗口（相对会话开始的毫秒），按开始时间排序
+ * @param {number} sessionId - 会话ID
+ * @param {number} baseTime - 会话开始时间戳
+ * @returns {Promise<{count:number,starts:Uint32Array,ends:Uint32Array,strokes:Uint16Array}>}
+ */
+function loadRallyWindows(sessionId, baseTime) {
+  return dbManager.executeSql({ sql: RALLY_WINDOWS_SQL, args: [sessionId] })
+    .then(data => {
+      const rows = data && data.rows ? data.rows : []
+      const windows = {
+        count: rows.length,
+        starts: new Uint32Array(rows.length),
+        ends: new Uint32Array(rows.length),
+        strokes: new Uint16Array(rows.length)
+      }
+      rows.forEach((row, i) => {
+        windows.starts[i] = Math.max(0, row.first_t - baseTime)
+        // 窗口含最后一拍
+        windows.ends[i] = Math.max(0, row.last_t - baseTime) + 1
+        windows.strokes[i] = Math.min(0xFFFF, row.n)
+      })
+      return windows
+    })
+}
+
+function loadStrokeMix(sessionId, summary) {
+  return dbManager.executeSql({ sql: STROKE_MIX_SQL, args: [sessionId] })
+    .then(data => {
+      const rows = data && data.rows ? data.rows : []
+      const mix = { forehand: 0, backhand: 0, smash: 0, total: 0, avgSpeed: 0 }
+      let speedSum = 0
+
+      rows.forEach(row => {
+        if (row.type & STROKE_FLAG.FOREHAND) mix.forehand += row.n
+        if (row.type & STROKE_FLAG.BACKHAND) mix.backhand += row.n
+        if (row.type & STROKE_FLAG.SMASH) mix.smash += row.n
+        mix.total += row.n
+        speedSum += row.speed_sum || 0
+      })
+
+      // 旧会话没有逐拍明细，退回会话汇总
+      if (!mix.total) {
+        return {
+          forehand: summary.forehand || 0,
+          backhand: summary.backhand || 0,
+          smash: summary.smashes || 0,
+          total: summary.strokes || 0,
+          avgSpeed: 0
+        }
+      }
+
+      mix.avgSpeed = Math.round(speedSum / mix.total * 10) / 10
+      return mix
+    })
+}
+
+function loadSpeedHistogram(sessionId) {
+  return dbManager.executeSql({ sql: HISTOGRAM_BY_SESSION_SQL, args: [sessionId, HISTOGRAM_METRIC.SPEED] })
+    .then(data => (data && data.rows ? data.rows : []))
+}
+
+/**
+ * 把列式序列按分段求均值：序列与分段都按时间有序，一次顺序扫描完成
+ * @param {{t:Uint32Array,v:Float32Array,length:number}} series - 列式序列（t 为相对毫秒）
+ * @param {Uint32Array} starts - 分段起点（含）
+ * @param {Uint32Array} ends - 分段终点（不含），分段互不重叠
+ * @returns {Float32Array} 各分段均值，无样本的分段为 NaN
+ */
+export function bucketMeans(series, starts, ends) {
+  const means = new Float32Array(starts.length).fill(NaN)
+  const t = series.t
+  const v = series.v
+  let i = 0
+
+  for (let k = 0; k < starts.length; k++) {
+    while (i < series.length && t[i] < starts[k]) i++
+
+    let sum = 0
+    let count = 0
+    while (i < series.length && t[i] < ends[k]) {
+      if (v[i] > 0) {
+        sum += v[i]
+        count++
+      }
+      i++
+    }
+    if (count) means[k] = sum / count
+  }
+
+  return means
+}
+
+/**
+ * 逐段求差（b - a）及统计，只计两边都有样本的分段
+ * @param {Float32Array} a - 分段均值
+ * @param {Float32Array} b - 分段均值
+ * @returns {{a:Float32Array,b:Float32Array,diff:Float32Array,overlap:number,meanDiff:number,maxDiff:number}}
+ */
+export function diffBuckets(a, b) {
+  const length = Math.min(a.length, b.length)
+  const diff = new Float32Array(length).fill(NaN)
+  let overlap = 0
+  let sum = 0
+  let maxDiff = 0
+
+  for (let k = 0; k < length; k++) {
+    if (a[k] !== a[k] || b[k] !== b[k]) continue
+    const d = b[k] - a[k]
+    diff[k] = d
+    overlap++
+    sum += d
+    if (Math.abs(d) > Math.abs(maxDiff)) maxDiff = d
+  }
+
+  return {
+    a,
+    b,
+    diff,
+    overlap,
+    meanDiff: overlap ? Math.round(sum / overlap * 10) / 10 : 0,
+    maxDiff: Math.round(maxDiff * 10) / 10
+  }
+}
+
+/**
+ * 两个按箱有序的直方图双指针归并为共同箱序列，计数换算为占比
+ * @param {Array<{bin:number,count:number}>} a - 直方图
+ * @param {Array<{bin:number,count:number}>} b - 直方图
+ * @returns {{bins:Uint16Array,shareA:Float32Array,shareB:Float32Array}}
+ */
+export function mergeHistograms(a, b) {
+  const totalA = a.reduce((sum, row) => sum + row.count, 0) || 1
+  const totalB = b.reduce((sum, row) => sum + row.count, 0) || 1
+  const bins = []
+  const shareA = []
+  const shareB = []
+  let i = 0
+  let j = 0
+
+  while (i < a.length || j < b.length) {
+    const binA = i < a.length ? a[i].bin : Infinity
+    const binB = j < b.length ? b[j].bin : Infinity
+    const bin = Math.min(binA, binB)
+    bins.push(bin)
+    shareA.push(binA === bin ? a[i++].count / totalA : 0)
+    shareB.push(binB === bin ? b[j++].count / totalB : 0)
+  }
+
+  return { bins: Uint16Array.from(bins), shareA: Float32Array.from(shareA), shareB: Float32Array.from(shareB) }
+}
+
+function elapsedBuckets(durationMs) {
+  const step = Math.max(COMPARE_MIN_STEP, Math.ceil(durationMs / COMPARE_MAX_BUCKETS / COMPARE_MIN_STEP) * COMPARE_MIN_STEP)
+  const count = Math.max(1, Math.ceil(durationMs / step))
+  const starts = new Uint32Array(count)
+  const ends = new Uint32Array(count)
+  for (let k = 0; k < count; k++) {
+    starts[k] = k * step
+    ends[k] = (k + 1) * step
+  }
+  return { step, starts, ends }
+}
+
+function seriesSpan(session) {
+  const last = series => (series.length ? series.t[series.length - 1] + 1 : 0)
+  return Math.max(last(session.heartRate), last(session.speed), (session.summary.duration || 0) * 1000)
+}
+
+function rallyTempo(windows) {
+  // 回合节奏：相邻两拍的平均间隔（毫秒），单拍回合为 NaN
+  const tempo = new Float32Array(windows.count).fill(NaN)
+  for (let k = 0; k < windows.count; k++) {
+    if (windows.strokes[k] > 1) tempo[k] = (windows.ends[k] - 1 - windows.starts[k]) / (windows.strokes[k] - 1)
+  }
+  return tempo
+}
+
+function sessionSide(sessionId, session, mix, quantiles) {
+  const summary = session.summary
+  return {
+    id: sessionId,
+    startTime: session.startTime,
+    duration: summary.duration || 0,
+    calories: summary.calories || 0,
+    avgHeartRate: summary.avg_heart_rate || 0,
+    maxSpeed: summary.max_speed || 0,
+    speedQuantiles: quantiles,
+    strokeMix: mix
+  }
+}
+
+/**
+ * 查找开始时间早于指定会话的最近一场会话（Report 默认与之对比）
+ * @param {number} sessionId - 会话ID
+ * @returns {Promise<number|null>} 上一场会话ID，没有时为 null
+ */
+export function findPreviousSessionId(sessionId) {
+  return dbManager.executeSql({ sql: PREVIOUS_SESSION_SQL, args: [sessionId] })
+    .then(data => (data && data.rows && data.rows.length ? data.rows[0].id : null))
+}
+
+/**
+ * 对比两个会话
+ * @param {number} baseId - 基准会话ID（a）
+ * @param {number} targetId - 对比会话ID（b），差值为 b - a
+ * @param {{align?:string}} options - align 为 COMPARE_ALIGN，默认按运动时长对齐
+ * @returns {Promise<Object>} 对比结果：a / b 两侧汇总与击球构成，heartRate / speed 分段曲线与差值，
+ *   speedDistribution 共同箱占比，rallies 按回合序号对齐的拍数与节奏；按回合对齐时曲线分段即回合窗口
+ */
+export function compareSessions(baseId, targetId, options = {}) {
+  const align = options.align === COMPARE_ALIGN.RALLY ? COMPARE_ALIGN.RALLY : COMPARE_ALIGN.ELAPSED
+  const startedAt = Date.now()
+
+  return Promise.all([loadColumnarSession(baseId), loadColumnarSession(targetId)])
+    .then(([a, b]) => Promise.all([
+      loadRallyWindows(baseId, a.startTime),
+      loadRallyWindows(targetId, b.startTime),
+      loadStrokeMix(baseId, a.summary),
+      loadStrokeMix(targetId, b.summary),
+      loadSpeedHistogram(baseId),
+      loadSpeedHistogram(targetId)
+    ])
+    .then(([ralliesA, ralliesB, mixA, mixB, histogramA, histogramB]) => {
+      const quantiles = [0.5, 0.9]
+      const rallyCount = Math.min(ralliesA.count, ralliesB.count)
+      let bucketsA
+      let bucketsB
+      let step = 0
+
+      if (align === COMPARE_ALIGN.RALLY) {
+        bucketsA = { starts: ralliesA.starts.subarray(0, rallyCount), ends: ralliesA.ends.subarray(0, rallyCount) }
+        bucketsB = { starts: ralliesB.starts.subarray(0, rallyCount), ends: ralliesB.ends.subarray(0, rallyCount) }
+      } else {
+        bucketsA = elapsedBuckets(Math.max(seriesSpan(a), seriesSpan(b)))
+        bucketsB = bucketsA
+        step = bucketsA.step
+      }
+
+      const result = {
+        align,
+        step,
+        a: sessionSide(baseId, a, mixA, histogramQuantiles(HISTOGRAM_METRIC.SPEED, histogramA, quantiles)),
+        b: sessionSide(targetId, b, mixB, histogramQuantiles(HISTOGRAM_METRIC.SPEED, histogramB, quantiles)),
+        heartRate: diffBuckets(
+          bucketMeans(a.heartRate, bucketsA.starts, bucketsA.ends),
+          bucketMeans(b.heartRate, bucketsB.starts, bucketsB.ends)
+        ),
+        speed: diffBuckets(
+          bucketMeans(a.speed, bucketsA.starts, bucketsA.ends),
+          bucketMeans(b.speed, bucketsB.starts, bucketsB.ends)
+        ),
+        speedDistribution: mergeHistograms(histogramA, histogramB),
+        rallies: {
+          countA: ralliesA.count,
+          countB: ralliesB.count,
+          strokesA: ralliesA.strokes.subarray(0, rallyCount),
+          strokesB: ralliesB.strokes.subarray(0, rallyCount),
+          tempo: diffBuckets(rallyTempo(ralliesA).subarray(0, rallyCount), rallyTempo(ralliesB).subarray(0, rallyCount))
+        }
+      }
+
+      console.log(`会话对比(${align}): ${baseId} vs ${targetId}, 耗时 ${Date.now() - startedAt}ms`)
+      return result
+    }))
+}
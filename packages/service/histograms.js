@@ -0,0 +1,181 @@
+/**
+ * 分布直方图模块
+ * 每个会话入库时按固定分箱统计拍速（逐拍速度，无明细时取拍速趋势）与心率分布，
+ * 周期汇总直方图随会话增删在同一事务内合并，任意区间的分位数只需读取区间内的汇总桶
+ */
+import dbManager from '../core/utils/database'
+import { HISTOGRAM_VERSION, HISTOGRAM_METRIC, buildHistogram, histogramQuantiles } from '../core/utils/histogram'
+import { applySessionHistogramRollups, ensureRollups, getRollupHistogram, pickRollupPeriod } from './rollups'
+
+// 每条 INSERT 的最大行数（4 个参数/行）
+const ROWS_PER_INSERT = 200
+// 回填每片处理的会话数与片间间隔
+const BACKFILL_SLICE_SIZE = 2
+const BACKFILL_SLICE_DELAY = 200
+
+const HISTOGRAM_ROW_PLACEHOLDER = '(?, ?, ?, ?)'
+const HISTOGRAM_INSERT_PREFIX = 'INSERT OR REPLACE INTO session_histograms (session_id, metric, bin, count) VALUES '
+const HISTOGRAM_DELETE_SQL = 'DELETE FROM session_histograms WHERE session_id = ?'
+const HISTOGRAM_VERSION_SQL = 'UPDATE sessions SET histogram_version = ? WHERE id = ?'
+const SESSION_SERIES_SQL = 'SELECT heart_rate_series, speed_series FROM sessions WHERE id = ?'
+const STROKE_SPEEDS_SQL = 'SELECT speed AS v FROM session_strokes WHERE session_id = ? AND speed > 0'
+const BACKFILL_CANDIDATES_SQL = 'SELECT id FROM sessions WHERE histogram_version < ? LIMIT ?'
+
+let backfilling = null
+
+function wait(ms) {
+  return new Promise(resolve => setTimeout(resolve, ms))
+}
+
+function toSamples(payload) {
+  if (!payload) return []
+  if (Array.isArray(payload)) return payload
+  try {
+    const samples = JSON.parse(payload)
+    return Array.isArray(samples) ? samples : []
+  } catch (e) {
+    return []
+  }
+}
+
+function speedSamples(strokeSpeeds, speedSeries) {
+  // 逐拍速度即挥拍速度分布；旧会话或无明细时退回拍速趋势
+  const strokes = (strokeSpeeds || []).filter(stroke => stroke && stroke.speed > 0)
+  return strokes.length ? strokes.map(stroke => stroke.speed) : toSamples(speedSeries)
+}
+
+function writeHistograms(tx, sessionId, heartRateSamples, speedSampleList) {
+  const args = []
+  const append = (metric, histogram) => {
+    histogram.forEach((count, bin) => {
+      args.push(sessionId, metric, bin, count)
+    })
+  }
+  append(HISTOGRAM_METRIC.SPEED, buildHistogram(HISTOGRAM_METRIC.SPEED, speedSampleList))
+  append(HISTOGRAM_METRIC.HEART_RATE, buildHistogram(HISTOGRAM_METRIC.HEART_RATE, heartRateSamples))
+
+  let chain = Promise.resolve()
+  const rowArgs = 4
+  for (let i = 0; i < args.length; i += ROWS_PER_INSERT * rowArgs) {
+    const chunk = args.slice(i, i + ROWS_PER_INSERT * rowArgs)
+    const sql = HISTOGRAM_INSERT_PREFIX + new Array(chunk.length / rowArgs).fill(HISTOGRAM_ROW_PLACEHOLDER).join(', ')
+    chain = chain.then(() => tx.executeSql({ sql, args: chunk }))
+  }
+
+  return chain.then(() => tx.executeSql({ sql: HISTOGRAM_VERSION_SQL, args: [HISTOGRAM_VERSION, sessionId] }))
+}
+
+/**
+ * 在事务内写入新会话的直方图（须在计入汇总之前调用）
+ * @param {Object} tx - 事务上下文
+ * @param {number} sessionId - 会话ID
+ * @param {Object} session - 会话数据（heartRateSeries / speedSeries / strokeEvents）
+ * @returns {Promise}
+ */
+export function insertSessionHistograms(tx, sessionId, session) {
+  if (!sessionId || !session) return Promise.resolve()
+
+  return writeHistograms(
+    tx,
+    sessionId,
+    toSamples(session.heartRateSeries || session.heart_rate_series),
+    speedSamples(session.strokeEvents, session.speedSeries || session.speed_series)
+  )
+}
+
+/**
+ * 在事务内按库中的序列与逐拍明细重算会话直方图（不处理汇总，调用方负责先移出再计入）
+ * @param {Object} tx - 事务上下文
+ * @param {number} sessionId - 会话ID
+ * @returns {Promise}
+ */
+export function rebuildSessionHistograms(tx, sessionId) {
+  return Promise.all([
+    tx.executeSql({ sql: SESSION_SERIES_SQL, args: [sessionId] }),
+    tx.executeSql({ sql: STROKE_SPEEDS_SQL, args: [sessionId] })
+  ])
+  .then(([sessionData, strokeData]) => {
+    const row = sessionData && sessionData.rows && sessionData.rows[0]
+    if (!row) return null
+
+    const strokes = (strokeData && strokeData.rows ? strokeData.rows : []).map(stroke => ({ speed: stroke.v }))
+    return tx.executeSql({ sql: HISTOGRAM_DELETE_SQL, args: [sessionId] })
+      .then(() => writeHistograms(tx, sessionId, toSamples(row.heart_rate_series), speedSamples(strokes, row.speed_series)))
+  })
+}
+
+/**
+ * 在事务内删除会话直方图
+ * @param {Object} tx - 事务上下文
+ * @param {number} sessionId - 会话ID
+ * @returns {Promise}
+ */
+export function deleteSessionHistograms(tx, sessionId) {
+  return tx.executeSql({ sql: HISTOGRAM_DELETE_SQL, args: [sessionId] })
+}
+
+/**
+ * 后台回填分箱版本落后的会话直方图（升级前的旧会话），分片执行
+ * @returns {Promise<number>} 回填的会话数
+ */
+export function backfillHistograms() {
+  if (backfilling) return backfilling
+
+  const startedAt = Date.now()
+  let processed = 0
+
+  const nextSlice = () => dbManager.executeSql({
+    sql: BACKFILL_CANDIDATES_SQL,
+    args: [HISTOGRAM_VERSION, BACKFILL_SLICE_SIZE]
+  })
+  .then(data => {
+    const rows = data && data.rows ? data.rows : []
+    if (!rows.length) return processed
+
+    return dbManager.transaction(tx => rows.reduce((chain, row) => chain
+      .then(() => applySessionHistogramRollups(tx, row.id, -1))
+      .then(() => rebuildSessionHistograms(tx, row.id))
+      .then(() => applySessionHistogramRollups(tx, row.id, 1)), Promise.resolve()))
+      .then(() => {
+        processed += rows.length
+        return wait(BACKFILL_SLICE_DELAY).then(nextSlice)
+      })
+  })
+
+  backfilling = ensureRollups()
+    .then(nextSlice)
+    .then(count => {
+      if (count) console.log(`直方图回填: ${count} 个会话, 耗时 ${Date.now() - startedAt}ms`)
+      return count
+    })
+    .catch(err => {
+      console.error('直方图回填失败:', err)
+      return processed
+    })
+    .then(count => {
+      backfilling = null
+      return count
+    })
+
+  return backfilling
+}
+
+/**
+ * 读取区间内的分布分位数，由周期汇总直方图合并得到（跨度≤62天按日汇总，否则按月）
+ * @param {string} metric - HISTOGRAM_METRIC
+ * @param {number} startTime - 开始时间戳（毫秒，含）
+ * @param {number} endTime - 结束时间戳（毫秒，不含）
+ * @param {Array<number>} quantiles - 分位点，默认 p50 / p90
+ * @returns {Promise<{count:number,values:Array<number>}>} 样本数与分位数
+ */
+export function getDistributionByRange(metric, startTime, endTime, quantiles = [0.5, 0.9]) {
+  return getRollupHistogram(pickRollupPeriod(startTime, endTime), metric, startTime, endTime)
+    .then(rows => ({
+      count: rows.reduce((sum, row) => sum + (row.count || 0), 0),
+      values: histogramQuantiles(metric, rows, quantiles)
+    }))
+    .catch(err => {
+      console.error('获取分布失败:', err)
+      return { count: 0, values: quantiles.map(() => 0) }
+    })
+}
@@ -5,4 +5,17 @@
 
 export * from './api'
 export * from './healthSync'
-export * from './storage' 
\ No newline at end of file
+export * from './storage'
+export * from './rollups'
+export * from './checkpoint'
+export * from './archive'
+export * from './retention'
+export * from './queryPlan'
+export * from './strokes'
+export * from './backup'
+export * from './histograms'
+export * from './personalBests'
+export * from './achievements'
+export * from './calendar'
+export * from './compare'
+export * from './timeline'
\ No newline at end of file
@@ -0,0 +1,194 @@
+/**
+ * 个人最佳模块
+ * 每个指标在 personal_bests 中保留前 PERSONAL_BEST_DEPTH 名，随会话写入在同一事务内增删，
+ * 表内始终是真实排名的前若干名：新会话只有排在表内最后一名之前（或表内已含全部会话）才进入，
+ * 删除只移除对应行；删到不足 PERSONAL_BEST_MIN_DEPTH 名时才从会话表补齐
+ * 连续运动天数由日汇总计算，与会话总数无关
+ */
+import dbManager from '../core/utils/database'
+import { ensureRollups, getRollups } from './rollups'
+
+// 指标即 sessions 中的列名
+export const PERSONAL_BEST_METRIC = {
+  MAX_SPEED: 'max_speed',
+  DURATION: 'duration',
+  STROKES: 'strokes',
+  CALORIES: 'calories'
+}
+
+// 每个指标保留的名次
+const PERSONAL_BEST_DEPTH = 5
+// 低于该名次数且会话表中还有其他会话时补齐
+const PERSONAL_BEST_MIN_DEPTH = 3
+
+const METRICS = Object.keys(PERSONAL_BEST_METRIC).map(key => PERSONAL_BEST_METRIC[key])
+
+const SESSION_TOTAL_SQL = `(SELECT IFNULL(SUM(session_count), 0) FROM session_rollups WHERE period = 'month')`
+
+// 排名高于表内最后一名（值相同时会话更早）才进入；表为空时比较结果为 NULL，只有表内已含其余全部会话时才进入
+const ADD_SQLS = METRICS.map(metric => `
+  INSERT OR REPLACE INTO personal_bests (metric, session_id, value, start_time)
+  SELECT '${metric}', id, IFNULL(${metric}, 0), start_time FROM sessions
+  WHERE id = ? AND (
+    (IFNULL(${metric}, 0), -id) > (
+      SELECT value, -session_id FROM personal_bests WHERE metric = '${metric}'
+      ORDER BY value ASC, session_id DESC LIMIT 1
+    )
+    OR (SELECT COUNT(*) FROM personal_bests WHERE metric = '${metric}') >= ${SESSION_TOTAL_SQL} - 1
+  )
+`)
+
+const TRIM_SQL = `
+  DELETE FROM personal_bests
+  WHERE metric = ? AND session_id NOT IN (
+    SELECT session_id FROM personal_bests WHERE metric = ?
+    ORDER BY value DESC, session_id ASC LIMIT ${PERSONAL_BEST_DEPTH}
+  )
+`
+
+const REMOVE_SQL = 'DELETE FROM personal_bests WHERE session_id = ?'
+
+const DEPTH_SQL = `
+  SELECT metric, COUNT(*) AS depth FROM personal_bests GROUP BY metric
+`
+
+const REFILL_SQLS = METRICS.reduce((sqls, metric) => {
+  sqls[metric] = [
+    { sql: `DELETE FROM personal_bests WHERE metric = '${metric}'` },
+    {
+      sql: `
+        INSERT INTO personal_bests (metric, session_id, value, start_time)
+        SELECT '${metric}', id, IFNULL(${metric}, 0), start_time FROM sessions
+        ORDER BY IFNULL(${metric}, 0) DESC, id ASC LIMIT ${PERSONAL_BEST_DEPTH}
+      `
+    }
+  ]
+  return sqls
+}, {})
+
+const SELECT_BESTS_SQL = `
+  SELECT metric, session_id, value, start_time FROM personal_bests
+  ORDER BY metric ASC, value DESC, session_id ASC
+`
+
+const TOTAL_SQL = `SELECT ${SESSION_TOTAL_SQL} AS total`
+
+/**
+ * 找出名次不足且会话表中还有其他会话的指标
+ * @param {Function} executeSql - tx.executeSql 或 dbManager.executeSql
+ * @returns {Promise<Array<string>>} 需要补齐的指标
+ */
+function findStaleMetrics(executeSql) {
+  return Promise.all([executeSql({ sql: DEPTH_SQL }), executeSql({ sql: TOTAL_SQL })])
+  .then(([depthData, totalData]) => {
+    const total = Number(totalData && totalData.rows && totalData.rows[0] && totalData.rows[0].total) || 0
+    const depths = {}
+    ;(depthData && depthData.rows ? depthData.rows : []).forEach(row => {
+      depths[row.metric] = Number(row.depth) || 0
+    })
+
+    return METRICS.filter(metric => {
+      const depth = depths[metric] || 0
+      return depth < PERSONAL_BEST_MIN_DEPTH && depth < total
+    })
+  })
+}
+
+/**
+ * 补齐名次不足的指标（须在事务内、会话行与汇总均已更新后调用）
+ * @param {Object} tx - 事务上下文
+ * @returns {Promise}
+ */
+export function refillPersonalBests(tx) {
+  return findStaleMetrics(statement => tx.executeSql(statement))
+    .then(stale => {
+      if (stale.length) console.log('个人最佳补齐:', stale.join(','))
+
+      return stale.reduce((chain, metric) => REFILL_SQLS[metric].reduce(
+        (inner, statement) => inner.then(() => tx.executeSql(statement)),
+        chain
+      ), Promise.resolve())
+    })
+}
+
+/**
+ * 将会话计入/移出个人最佳，须在 dbManager.transaction 的 tx 内调用
+ * 计入须在会话行写入并计入汇总之后；移出只删除对应行，删除会话时在删除会话行后调用 refillPersonalBests
+ * @param {Object} tx - 事务上下文
+ * @param {number} sessionId - 会话ID
+ * @param {number} sign - 1 计入，-1 移出
+ * @returns {Promise}
+ */
+export function applySessionBests(tx, sessionId, sign) {
+  if (sign < 0) return tx.executeSql({ sql: REMOVE_SQL, args: [sessionId] })
+
+  return METRICS.reduce((chain, metric, index) => chain
+    .then(() => tx.executeSql({ sql: ADD_SQLS[index], args: [sessionId] }))
+    .then(() => tx.executeSql({ sql: TRIM_SQL, args: [metric, metric] })), Promise.resolve())
+    .then(() => refillPersonalBests(tx))
+}
+
+/**
+ * 读取各指标的个人最佳排名
+ * @returns {Promise<Object<string, Array<{sessionId:number,value:number,startTime:number}>>>} 指标 -> 名次（第一名在前）
+ */
+export function getPersonalBests() {
+  const read = () => dbManager.executeSql({ sql: SELECT_BESTS_SQL })
+    .then(data => {
+      const bests = {}
+      METRICS.forEach(metric => {
+        bests[metric] = []
+      })
+      ;(data && data.rows ? data.rows : []).forEach(row => {
+        if (!bests[row.metric]) return
+        bests[row.metric].push({ sessionId: row.session_id, value: row.value, startTime: row.start_time })
+      })
+      return bests
+    })
+
+  // 升级后首次读取或汇总重建后，由会话表回填
+  return ensureRollups()
+    .then(() => findStaleMetrics(statement => dbManager.executeSql(statement)))
+    .then(stale => (stale.length ? dbManager.transaction(tx => refillPersonalBests(tx)) : null))
+    .then(read)
+    .catch(err => {
+      console.error('读取个人最佳失败:', err)
+      return {}
+    })
+}
+
+function nextDay(timestamp) {
+  const date = new Date(timestamp)
+  date.setDate(date.getDate() + 1)
+  return date.getTime()
+}
+
+/**
+ * 连续运动天数：由日汇总行计算，代价与有运动的天数成正比
+ * @param {number} now - 当前时间戳（毫秒），用于判断当前连续是否已中断
+ * @returns {Promise<{current:number,longest:number,lastDay:number}>} 当前连续天数（今天或昨天有运动才计）、最长连续天数、最近运动日零点
+ */
+export function getStreaks(now = Date.now()) {
+  return getRollups('day', 0, Number.MAX_SAFE_INTEGER)
+    .then(rows => {
+      let longest = 0
+      let run = 0
+      let previous = null
+
+      rows.forEach(row => {
+        run = previous !== null && nextDay(previous) === row.period_start ? run + 1 : 1
+        if (run > longest) longest = run
+        previous = row.period_start
+      })
+
+      const today = new Date(now)
+      today.setHours(0, 0, 0, 0)
+      const active = previous !== null && (previous === today.getTime() || nextDay(previous) === today.getTime())
+
+      return { current: active ? run : 0, longest, lastDay: previous || 0 }
+    })
+    .catch(err => {
+      console.error('计算连续运动天数失败:', err)
+      return { current: 0, longest: 0, lastDay: 0 }
+    })
+}
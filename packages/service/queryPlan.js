@@ -0,0 +1,66 @@
+/**
+ * 查询计划检查
+ * 用 EXPLAIN QUERY PLAN 确认历史筛选查询都走索引，不做全表扫描或临时排序；
+ * 调整索引或筛选条件后在设备/模拟器上长按设置页的「版本」行运行 checkHistoryQueryPlans 核对
+ */
+import dbManager from '../core/utils/database'
+import { buildHistoryQuery, buildHistoryCountQuery } from './storage'
+
+const DAY_MS = 24 * 60 * 60 * 1000
+
+// 需要覆盖的筛选组合
+export const HISTORY_PLAN_CASES = [
+  {},
+  { mode: 'singles' },
+  { startTime: 0, endTime: 30 * DAY_MS },
+  { mode: 'doubles', startTime: 0, endTime: 30 * DAY_MS },
+  { minDuration: 1800 },
+  { minStrokes: 100 },
+  { minCalories: 200 },
+  { mode: 'singles', minStrokes: 100, minCalories: 200 },
+  { startTime: 0, endTime: 30 * DAY_MS, minDuration: 1800, minStrokes: 100 }
+]
+
+const CURSOR_SAMPLE = { startTime: 7 * DAY_MS, id: 1 }
+
+/**
+ * 判断查询计划是否合格：不允许无索引的 SCAN sessions 与 TEMP B-TREE 排序
+ * @param {Array<{detail:string}>} rows - EXPLAIN QUERY PLAN 结果
+ * @returns {string|null} 不合格的计划行，合格时为 null
+ */
+export function findPlanViolation(rows) {
+  const bad = (rows || []).find(row => {
+    const detail = row.detail || ''
+    const tableScan = /^SCAN (TABLE )?sessions\b/.test(detail) && detail.indexOf(' USING ') < 0
+    return tableScan || detail.indexOf('TEMP B-TREE') >= 0
+  })
+  return bad ? bad.detail : null
+}
+
+function explain(query) {
+  return dbManager.executeSql({ sql: `EXPLAIN QUERY PLAN ${query.sql}`, args: query.args })
+    .then(data => (data && data.rows ? data.rows : []))
+}
+
+/**
+ * 检查所有筛选组合（首页、翻页、计数）的查询计划
+ * @returns {Promise<{ok:boolean,failures:Array<{filters:Object,kind:string,detail:string}>}>} 检查结果
+ */
+export function checkHistoryQueryPlans() {
+  const checks = []
+  HISTORY_PLAN_CASES.forEach(filters => {
+    checks.push({ filters, kind: 'page', query: buildHistoryQuery(filters, null, 21) })
+    checks.push({ filters, kind: 'cursor', query: buildHistoryQuery(filters, CURSOR_SAMPLE, 21) })
+    checks.push({ filters, kind: 'count', query: buildHistoryCountQuery(filters) })
+  })
+
+  return checks.reduce((chain, check) => chain.then(failures => explain(check.query)
+    .then(rows => {
+      const detail = findPlanViolation(rows)
+      return detail ? failures.concat({ filters: check.filters, kind: check.kind, detail }) : failures
+    })), Promise.resolve([]))
+    .then(failures => {
+      failures.forEach(failure => console.error('查询计划未走索引:', JSON.stringify(failure)))
+      return { ok: !failures.length, failures }
+    })
+}
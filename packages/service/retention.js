@@ -0,0 +1,159 @@
+/**
+ * 数据保留模块
+ * 按会话年龄把趋势序列分层降采样（原始 → 10 秒桶 → 1 分钟桶，保留 平均/最小/最大），
+ * 汇总字段不变；后台分片执行，每片只处理少量会话，片间让出主线程
+ */
+import dbManager from '../core/utils/database'
+import { bucketSeries } from '../core/utils/downsample'
+import { parseSeries, serializeSeries, toArchiveSession } from './storage'
+import { writeSessionArchive } from './archive'
+
+const DAY_MS = 24 * 60 * 60 * 1000
+
+// 默认分层：超过 afterDays 天的会话降到 resolution 毫秒一个点，未到第一层保持原始分辨率
+export const DEFAULT_RETENTION_TIERS = [
+  { afterDays: 30, resolution: 10 * 1000 },
+  { afterDays: 180, resolution: 60 * 1000 }
+]
+
+// 每片处理的会话数与片间间隔
+const SLICE_SIZE = 2
+const SLICE_DELAY = 200
+// 每轮结束时最多回收的空闲页数
+const VACUUM_PAGES = 256
+
+const RETENTION_CANDIDATES_SQL = `
+  SELECT * FROM sessions
+  WHERE series_resolution < ? AND start_time < ?
+  ORDER BY series_resolution ASC, start_time ASC
+  LIMIT ?
+`
+const RETENTION_UPDATE_SQL = `
+  UPDATE sessions SET heart_rate_series = ?, speed_series = ?, series_resolution = ?
+  WHERE id = ? AND series_resolution < ?
+`
+
+let running = null
+let stopRequested = false
+
+function wait(ms) {
+  return new Promise(resolve => setTimeout(resolve, ms))
+}
+
+function normalizeTiers(tiers) {
+  return (Array.isArray(tiers) ? tiers : DEFAULT_RETENTION_TIERS)
+    .filter(tier => tier && tier.afterDays >= 0 && tier.resolution > 0)
+    .sort((a, b) => b.resolution - a.resolution)
+}
+
+/**
+ * 取一片待降采样的会话；优先最粗一层，老会话直接由原始序列降到目标分辨率
+ */
+function nextSlice(tiers, now, sliceSize) {
+  return tiers.reduce((chain, tier) => chain.then(found => {
+    if (found) return found
+
+    return dbManager.executeSql({
+      sql: RETENTION_CANDIDATES_SQL,
+      args: [tier.resolution, now - tier.afterDays * DAY_MS, sliceSize]
+    })
+    .then(data => {
+      const rows = data && data.rows ? data.rows : []
+      return rows.length ? { tier, rows } : null
+    })
+  }), Promise.resolve(null))
+}
+
+function downsampleRow(tx, row, resolution) {
+  const heartRateSeries = bucketSeries(parseSeries(row.heart_rate_series), resolution)
+  const speedSeries = bucketSeries(parseSeries(row.speed_series), resolution)
+  const heartPayload = serializeSeries(heartRateSeries)
+  const speedPayload = serializeSeries(speedSeries)
+
+  const before = (row.heart_rate_series || '').length + (row.speed_series || '').length
+  const after = (heartPayload || '').length + (speedPayload || '').length
+
+  return tx.executeSql({
+    sql: RETENTION_UPDATE_SQL,
+    args: [heartPayload, speedPayload, resolution, row.id, resolution]
+  })
+  .then(data => {
+    if (!data || !data.rowsAffected) return 0
+
+    tx.afterCommit(() => writeSessionArchive(row.id, toArchiveSession({
+      ...row,
+      heartRateSeries,
+      speedSeries
+    })))
+    return Math.max(0, before - after)
+  })
+}
+
+/**
+ * 启动一轮数据保留整理；已在运行时返回同一个 Promise
+ * @param {{tiers?:Array<{afterDays:number,resolution:number}>,sliceSize?:number,sliceDelay?:number,now?:number}} options - 分层与分片参数
+ * @returns {Promise<{sessions:number,savedBytes:number}>} 本轮处理的会话数与序列缩减的字节数
+ */
+export function runRetention(options = {}) {
+  if (running) return running
+
+  const tiers = normalizeTiers(options.tiers)
+  const sliceSize = options.sliceSize || SLICE_SIZE
+  const sliceDelay = options.sliceDelay !== undefined ? options.sliceDelay : SLICE_DELAY
+  const now = options.now || Date.now()
+  const stats = { sessions: 0, savedBytes: 0 }
+  const startedAt = Date.now()
+
+  stopRequested = false
+
+  const step = () => {
+    if (stopRequested) return Promise.resolve(stats)
+
+    return nextSlice(tiers, now, sliceSize)
+      .then(slice => {
+        if (!slice) return stats
+
+        return dbManager.transaction(tx => slice.rows.reduce(
+          (chain, row) => chain.then(saved => downsampleRow(tx, row, slice.tier.resolution)
+            .then(bytes => saved + bytes)),
+          Promise.resolve(0)
+        ))
+        .then(saved => {
+          stats.sessions += slice.rows.length
+          stats.savedBytes += saved
+        })
+        .then(() => wait(sliceDelay))
+        .then(step)
+      })
+  }
+
+  running = (tiers.length ? step() : Promise.resolve(stats))
+    .then(() => {
+      if (!stats.sessions) return stats
+
+      // 新库启用了增量回收，把释放的页归还文件系统；旧库该语句无操作
+      return dbManager.batch([{ sql: `PRAGMA incremental_vacuum(${VACUUM_PAGES})` }])
+        .catch(err => console.error('回收空间失败:', err))
+        .then(() => {
+          console.log(`数据保留整理完成: ${stats.sessions} 个会话, 序列缩减 ${Math.round(stats.savedBytes / 1024)}KB, 耗时 ${Date.now() - startedAt}ms`)
+          return stats
+        })
+    })
+    .catch(err => {
+      console.error('数据保留整理失败:', err)
+      return stats
+    })
+    .then(result => {
+      running = null
+      return result
+    })
+
+  return running
+}
+
+/**
+ * 请求停止当前整理，已开始的一片会完成后再停止
+ */
+export function stopRetention() {
+  stopRequested = true
+}
@@ -0,0 +1,247 @@
+/**
+ * 统计汇总模块
+ * 按 日 / ISO周 / 月 维护会话汇总行，随会话写入在同一事务内增量更新
+ */
+import dbManager from '../core/utils/database'
+import { HISTOGRAM_METRIC } from '../core/utils/histogram'
+
+// 各周期桶起点（本地时间）的 SQL 表达式，结果为毫秒时间戳
+const PERIOD_BUCKETS = {
+  day: `CAST(strftime('%s', start_time / 1000, 'unixepoch', 'localtime', 'start of day', 'utc') AS INTEGER) * 1000`,
+  week: `CAST(strftime('%s', start_time / 1000, 'unixepoch', 'localtime', 'weekday 0', '-6 days', 'start of day', 'utc') AS INTEGER) * 1000`,
+  month: `CAST(strftime('%s', start_time / 1000, 'unixepoch', 'localtime', 'start of month', 'utc') AS INTEGER) * 1000`
+}
+
+// 跨度超过该天数时改用月汇总，保证与 History 的周/月/年区间边界对齐
+const MONTH_GRANULARITY_DAYS = 62
+
+const ROLLUP_COLUMNS = `
+  period, period_start, session_count, total_duration, total_calories,
+  total_strokes, total_smashes, heart_rate_weighted, max_speed_sum
+`
+
+const ROLLUP_UPSERT = `
+  ON CONFLICT(period, period_start) DO UPDATE SET
+    session_count = session_count + excluded.session_count,
+    total_duration = total_duration + excluded.total_duration,
+    total_calories = total_calories + excluded.total_calories,
+    total_strokes = total_strokes + excluded.total_strokes,
+    total_smashes = total_smashes + excluded.total_smashes,
+    heart_rate_weighted = heart_rate_weighted + excluded.heart_rate_weighted,
+    max_speed_sum = max_speed_sum + excluded.max_speed_sum
+`
+
+// 单条会话按 sign(+1/-1) 计入或移出三个周期的汇总
+const APPLY_SESSION_SQL = `
+  INSERT INTO session_rollups (${ROLLUP_COLUMNS})
+  ${Object.keys(PERIOD_BUCKETS).map(period => `
+  SELECT '${period}', ${PERIOD_BUCKETS[period]}, ?,
+    ? * IFNULL(duration, 0), ? * IFNULL(calories, 0), ? * IFNULL(strokes, 0),
+    ? * IFNULL(smashes, 0), ? * IFNULL(avg_heart_rate, 0) * IFNULL(duration, 0),
+    ? * IFNULL(max_speed, 0)
+  FROM sessions WHERE id = ?`).join(' UNION ALL')}
+  ${ROLLUP_UPSERT}
+`
+
+// 只清理该会话所在的三个桶，按主键定位，删除开销与历史总量无关
+const PRUNE_EMPTY_SQLS = Object.keys(PERIOD_BUCKETS).map(period => `
+  DELETE FROM session_rollups
+  WHERE period = '${period}'
+    AND period_start = (SELECT ${PERIOD_BUCKETS[period]} FROM sessions WHERE id = ?)
+    AND session_count <= 0
+`)
+
+const REBUILD_SQL = `
+  INSERT INTO session_rollups (${ROLLUP_COLUMNS})
+  ${Object.keys(PERIOD_BUCKETS).map(period => `
+  SELECT '${period}', ${PERIOD_BUCKETS[period]} AS bucket, COUNT(*),
+    SUM(IFNULL(duration, 0)), SUM(IFNULL(calories, 0)), SUM(IFNULL(strokes, 0)),
+    SUM(IFNULL(smashes, 0)), SUM(IFNULL(avg_heart_rate, 0) * IFNULL(duration, 0)),
+    SUM(IFNULL(max_speed, 0))
+  FROM sessions WHERE start_time IS NOT NULL GROUP BY bucket`).join(' UNION ALL')}
+`
+
+const SELECT_RANGE_SQL = `
+  SELECT period_start, session_count, total_duration, total_calories, total_strokes,
+    heart_rate_weighted, max_speed_sum
+  FROM session_rollups
+  WHERE period = ? AND period_start >= ? AND period_start < ?
+  ORDER BY period_start ASC
+`
+
+// 会话直方图按 sign 计入或移出三个周期的汇总直方图
+const APPLY_HISTOGRAM_SQL = `
+  INSERT INTO rollup_histograms (period, metric, period_start, bin, count)
+  ${Object.keys(PERIOD_BUCKETS).map(period => `
+  SELECT '${period}', h.metric, ${PERIOD_BUCKETS[period]}, h.bin, ? * h.count
+  FROM session_histograms h JOIN sessions s ON s.id = h.session_id
+  WHERE h.session_id = ?`).join(' UNION ALL')}
+  ON CONFLICT(period, metric, period_start, bin) DO UPDATE SET count = count + excluded.count
+`
+
+const HISTOGRAM_METRICS_SQL = Object.keys(HISTOGRAM_METRIC).map(key => `'${HISTOGRAM_METRIC[key]}'`).join(', ')
+
+// 只清理该会话所在桶内计数归零的箱，避免扫描整张表
+const PRUNE_HISTOGRAM_SQLS = Object.keys(PERIOD_BUCKETS).map(period => `
+  DELETE FROM rollup_histograms
+  WHERE period = '${period}' AND metric IN (${HISTOGRAM_METRICS_SQL})
+    AND period_start = (SELECT ${PERIOD_BUCKETS[period]} FROM sessions WHERE id = ?)
+    AND count <= 0
+`)
+
+const REBUILD_HISTOGRAM_SQL = `
+  INSERT INTO rollup_histograms (period, metric, period_start, bin, count)
+  ${Object.keys(PERIOD_BUCKETS).map(period => `
+  SELECT '${period}', h.metric, ${PERIOD_BUCKETS[period]} AS bucket, h.bin, SUM(h.count)
+  FROM session_histograms h JOIN sessions s ON s.id = h.session_id
+  WHERE s.start_time IS NOT NULL GROUP BY h.metric, bucket, h.bin`).join(' UNION ALL')}
+`
+
+const SELECT_HISTOGRAM_RANGE_SQL = `
+  SELECT bin, SUM(count) AS count
+  FROM rollup_histograms
+  WHERE period = ? AND metric = ? AND period_start >= ? AND period_start < ?
+  GROUP BY bin
+  ORDER BY bin ASC
+`
+
+let ensurePromise = null
+
+/**
+ * 将会话计入/移出汇总，须在 dbManager.transaction 的 tx 内调用
+ * @param {Object} tx - 事务上下文
+ * @param {number} sessionId - 会话ID
+ * @param {number} sign - 1 计入，-1 移出
+ * @returns {Promise}
+ */
+export function applySessionRollups(tx, sessionId, sign) {
+  const args = []
+  Object.keys(PERIOD_BUCKETS).forEach(() => {
+    args.push(sign, sign, sign, sign, sign, sign, sign, sessionId)
+  })
+
+  return tx.executeSql({ sql: APPLY_SESSION_SQL, args })
+    .then(() => {
+      if (sign >= 0) return null
+      return PRUNE_EMPTY_SQLS.reduce(
+        (chain, sql) => chain.then(() => tx.executeSql({ sql, args: [sessionId] })),
+        Promise.resolve()
+      )
+    })
+    .then(() => applySessionHistogramRollups(tx, sessionId, sign))
+}
+
+/**
+ * 将会话直方图计入/移出汇总直方图，须在事务内、会话行存在时调用
+ * @param {Object} tx - 事务上下文
+ * @param {number} sessionId - 会话ID
+ * @param {number} sign - 1 计入，-1 移出
+ * @returns {Promise}
+ */
+export function applySessionHistogramRollups(tx, sessionId, sign) {
+  const args = []
+  Object.keys(PERIOD_BUCKETS).forEach(() => {
+    args.push(sign, sessionId)
+  })
+
+  return tx.executeSql({ sql: APPLY_HISTOGRAM_SQL, args })
+    .then(() => {
+      if (sign >= 0) return null
+      return PRUNE_HISTOGRAM_SQLS.reduce(
+        (chain, sql) => chain.then(() => tx.executeSql({ sql, args: [sessionId] })),
+        Promise.resolve()
+      )
+    })
+}
+
+/**
+ * 清空并按会话表重建汇总，须在事务内调用
+ * @param {Object} tx - 事务上下文
+ * @returns {Promise}
+ */
+export function rebuildRollups(tx) {
+  return tx.executeSql({ sql: 'DELETE FROM session_rollups' })
+    .then(() => tx.executeSql({ sql: REBUILD_SQL }))
+    .then(() => tx.executeSql({ sql: 'DELETE FROM rollup_histograms' }))
+    .then(() => tx.executeSql({ sql: REBUILD_HISTOGRAM_SQL }))
+    // 个人最佳依赖汇总中的会话总数，清空后由 service/personalBests 首次读取时回填
+    .then(() => tx.executeSql({ sql: 'DELETE FROM personal_bests' }))
+}
+
+/**
+ * 确认汇总与会话表一致（旧版本数据首次启动时回填），每次启动只检查一次
+ * @returns {Promise}
+ */
+export function ensureRollups() {
+  if (ensurePromise) return ensurePromise
+
+  const countSql = `
+    SELECT
+      (SELECT COUNT(*) FROM sessions) AS sessions,
+      (SELECT IFNULL(SUM(session_count), 0) FROM session_rollups WHERE period = 'day') AS rolled
+  `
+
+  ensurePromise = dbManager.executeSql({ sql: countSql })
+    .then(data => {
+      const row = data && data.rows && data.rows[0]
+      if (!row || Number(row.sessions) === Number(row.rolled)) return true
+
+      console.log('汇总与会话不一致，重建汇总', row)
+      return dbManager.transaction(tx => rebuildRollups(tx)).then(() => true)
+    })
+    .catch(err => {
+      console.error('检查汇总失败:', err)
+      ensurePromise = null
+      return false
+    })
+
+  return ensurePromise
+}
+
+/**
+ * 按周期读取汇总行
+ * @param {string} period - 'day' | 'week' | 'month'
+ * @param {number} startTime - 开始时间戳（毫秒，含）
+ * @param {number} endTime - 结束时间戳（毫秒，不含）
+ * @returns {Promise<Array>} 汇总行
+ */
+export function getRollups(period, startTime, endTime) {
+  if (!PERIOD_BUCKETS[period]) return Promise.resolve([])
+
+  return ensureRollups()
+    .then(() => dbManager.executeSql({
+      sql: SELECT_RANGE_SQL,
+      args: [period, startTime, endTime]
+    }))
+    .then(data => (data && data.rows ? data.rows : []))
+}
+
+/**
+ * 读取区间内合并后的汇总直方图，代价与区间内的桶数成正比
+ * @param {string} period - 'day' | 'week' | 'month'
+ * @param {string} metric - HISTOGRAM_METRIC
+ * @param {number} startTime - 开始时间戳（毫秒，含）
+ * @param {number} endTime - 结束时间戳（毫秒，不含）
+ * @returns {Promise<Array<{bin:number,count:number}>>} 按箱升序的计数
+ */
+export function getRollupHistogram(period, metric, startTime, endTime) {
+  if (!PERIOD_BUCKETS[period]) return Promise.resolve([])
+
+  return ensureRollups()
+    .then(() => dbManager.executeSql({
+      sql: SELECT_HISTOGRAM_RANGE_SQL,
+      args: [period, metric, startTime, endTime]
+    }))
+    .then(data => (data && data.rows ? data.rows : []))
+}
+
+/**
+ * 根据区间跨度选择汇总粒度
+ * @param {number} startTime - 开始时间戳（毫秒）
+ * @param {number} endTime - 结束时间戳（毫秒）
+ * @returns {string} 汇总周期
+ */
+export function pickRollupPeriod(startTime, endTime) {
+  const spanDays = (endTime - startTime) / (24 * 60 * 60 * 1000)
+  return spanDays > MONTH_GRANULARITY_DAYS ? 'month' : 'day'
+}
@@ -3,8 +3,16 @@
  * 负责本地数据库操作
  */
 import dbManager from '../core/utils/database'
-
-function serializeSeries(series) {
+import { lttbPoints } from '../core/utils/downsample'
+import storageManager from '../core/utils/storage'
+import { applySessionRollups, ensureRollups, getRollups, pickRollupPeriod } from './rollups'
+import { writeSessionArchive, removeSessionArchive, clearSessionArchives } from './archive'
+import { insertStrokes, deleteStrokes } from './strokes'
+import { insertSessionHistograms, rebuildSessionHistograms, deleteSessionHistograms } from './histograms'
+import { applySessionBests, refillPersonalBests } from './personalBests'
+import { applySessionAchievements, reloadAchievements } from './achievements'
+
+export function serializeSeries(series) {
   if (!series || !Array.isArray(series)) return null
   try {
     return JSON.stringify(series)
@@ -14,7 +22,7 @@ function serializeSeries(series) {
   }
 }
 
-function parseSeries(payload) {
+export function parseSeries(payload) {
   if (!payload) return []
   if (Array.isArray(payload)) return payload
   try {
@@ -67,6 +75,80 @@ function parseWarningEvents(payload) {
   }
 }
 
+// SQL 文本只在模块加载时构建一次
+const SESSION_INSERT_SQL = `
+  INSERT INTO sessions (
+    mode, start_time, end_time, duration, calories, 
+    max_speed, avg_heart_rate, max_heart_rate, min_heart_rate, 
+    strokes, smashes, forehand, backhand, notes, heart_rate_series, speed_series,
+    scoreboard, heart_rate_warning_events, fatigue_level, fatigue_score, updated_at
+  ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+`
+const SESSION_BY_ID_SQL = 'SELECT * FROM sessions WHERE id = ?'
+// 报告页只取汇总字段，序列从会话归档读取
+const SESSION_SUMMARY_BY_ID_SQL = `
+  SELECT id, mode, start_time, end_time, duration, calories, max_speed,
+    avg_heart_rate, max_heart_rate, min_heart_rate, strokes, smashes,
+    forehand, backhand, notes, scoreboard, heart_rate_warning_events,
+    fatigue_level, fatigue_score
+  FROM sessions WHERE id = ?
+`
+const SESSION_DELETE_SQL = 'DELETE FROM sessions WHERE id = ?'
+
+/**
+ * 在事务内插入会话并计入汇总（调用方需先完成 ensureRollups）
+ * @param {Object} tx - dbManager.transaction 提供的事务上下文
+ * @param {Object} session - 会话数据
+ * @param {{achievements?:boolean}} options - achievements 为 false 时不计入成就进度（如从备份恢复）
+ * @returns {Promise<number>} 新会话ID
+ */
+export function insertSession(tx, session, options = {}) {
+  // 准备参数
+  const now = Date.now()
+  const params = [
+    session.mode || 'singles',
+    session.startTime || now,
+    session.endTime || 0,
+    session.duration || 0,
+    session.calories || 0,
+    session.maxSpeed || 0,
+    session.avgHeartRate || 0,
+    session.maxHeartRate || 0,
+    session.minHeartRate || 0,
+    session.strokes || 0,
+    session.smashes || 0,
+    session.forehand || 0,
+    session.backhand || 0,
+    session.notes || '',
+    serializeSeries(session.heartRateSeries || session.heart_rate_series),
+    serializeSeries(session.speedSeries || session.speed_series),
+    serializeScoreboard(session.scoreboard || session.scoreboard_data),
+    serializeWarningEvents(session.heartRateWarningEvents || session.heart_rate_warning_events),
+    session.fatigueLevel || 0,
+    session.fatigueScore || 0,
+    now
+  ]
+
+  return tx.executeSql({
+    sql: SESSION_INSERT_SQL,
+    args: params
+  })
+  .then(data => {
+    const insertId = (data && data.insertId) || 0
+    // 提交成功后再清缓存、写归档：提交前清缓存会被并发查询用未提交的旧数据回填，回滚时也不会留下孤儿文件
+    tx.afterCommit(invalidateHistoryCaches)
+    // 共用连接上的读取可能读到本事务未提交的行，回滚时同样作废
+    tx.afterRollback(invalidateHistoryCaches)
+    tx.afterCommit(() => writeSessionArchive(insertId, session))
+    return insertSessionHistograms(tx, insertId, session)
+      .then(() => applySessionRollups(tx, insertId, 1))
+      .then(() => applySessionBests(tx, insertId, 1))
+      .then(() => insertStrokes(tx, insertId, session.strokeEvents))
+      .then(() => (options.achievements === false ? null : applySessionAchievements(tx, session)))
+      .then(() => insertId)
+  })
+}
+
 /**
  * 保存会话数据到数据库
  * @param {Object} session - 会话数据
@@ -75,48 +157,12 @@ function parseWarningEvents(payload) {
 export function saveSession(session) {
   return new Promise((resolve, reject) => {
     try {
-      // 构建SQL语句
-      const sql = `
-        INSERT INTO sessions (
-          mode, start_time, end_time, duration, calories, 
-          max_speed, avg_heart_rate, max_heart_rate, min_heart_rate, 
-          strokes, smashes, forehand, backhand, notes, heart_rate_series, speed_series,
-          scoreboard, heart_rate_warning_events, updated_at
-        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-      `
-      
-      // 准备参数
-      const now = Date.now()
-      const params = [
-        session.mode || 'singles',
-        session.startTime || now,
-        session.endTime || 0,
-        session.duration || 0,
-        session.calories || 0,
-        session.maxSpeed || 0,
-        session.avgHeartRate || 0,
-        session.maxHeartRate || 0,
-        session.minHeartRate || 0,
-        session.strokes || 0,
-        session.smashes || 0,
-        session.forehand || 0,
-        session.backhand || 0,
-        session.notes || '',
-        serializeSeries(session.heartRateSeries || session.heart_rate_series),
-        serializeSeries(session.speedSeries || session.speed_series),
-        serializeScoreboard(session.scoreboard || session.scoreboard_data),
-        serializeWarningEvents(session.heartRateWarningEvents || session.heart_rate_warning_events),
-        now
-      ]
-      
-      // 执行SQL
-      dbManager.executeSql({
-        sql,
-        args: params
-      })
-      .then(data => {
-        console.log('会话保存成功', data)
-        resolve((data && data.insertId) || 0)
+      // 会话与汇总在同一事务内写入
+      ensureRollups()
+      .then(() => dbManager.transaction(tx => insertSession(tx, session)))
+      .then(insertId => {
+        console.log('会话保存成功', insertId)
+        resolve(insertId)
       })
       .catch(err => {
         console.error('会话保存失败:', err)
@@ -177,201 +223,264 @@ export function getAllSessions(limit = 0, offset = 0) {
   })
 }
 
+// 历史列表只取列表展示所需字段，不解析序列
+const HISTORY_COLUMNS = `
+  id, mode, start_time, duration, calories, strokes, avg_heart_rate,
+  max_heart_rate, min_heart_rate, max_speed, smashes, forehand, backhand
+`
+const HISTORY_ORDER = 'ORDER BY start_time DESC, id DESC'
+
+// 历史筛选条件：筛选键 → WHERE 子句，均有索引支撑（见 database.js 迁移 v5）
+const HISTORY_FILTERS = {
+  mode: 'mode = ?',
+  startTime: 'start_time >= ?',
+  endTime: 'start_time < ?',
+  minDuration: 'duration >= ?',
+  minStrokes: 'strokes >= ?',
+  minCalories: 'calories >= ?'
+}
+
+// 各筛选条件下的会话总数缓存，增删会话时整体失效
+let historyTotalCache = {}
+// 各区间的周期统计（含趋势序列）缓存，任何会话写入时整体失效
+let statsRangeCache = {}
+// 两类缓存共用的代次：查询期间发生写入提交或回滚时不写回缓存
+let historyCacheGeneration = 0
+
+function invalidateHistoryCaches() {
+  historyTotalCache = {}
+  statsRangeCache = {}
+  historyCacheGeneration++
+}
+
+function buildHistoryWhere(filters) {
+  const clauses = []
+  const args = []
+
+  Object.keys(HISTORY_FILTERS).forEach(key => {
+    const value = filters && filters[key]
+    if (value === undefined || value === null || value === '') return
+    clauses.push(HISTORY_FILTERS[key])
+    args.push(value)
+  })
+
+  return { clauses, args }
+}
+
+/**
+ * 构建历史列表查询（游标 (start_time, id) 做范围定位，深页与首页代价相同）
+ * @param {{mode?:string,startTime?:number,endTime?:number,minDuration?:number,minStrokes?:number,minCalories?:number}} filters - 筛选条件
+ * @param {{startTime:number,id:number}|null} cursor - 游标
+ * @param {number} limit - 条数
+ * @returns {{sql:string,args:Array}} 查询
+ */
+export function buildHistoryQuery(filters, cursor, limit) {
+  const { clauses, args } = buildHistoryWhere(filters)
+
+  if (cursor && cursor.startTime !== undefined) {
+    clauses.push('(start_time, id) < (?, ?)')
+    args.push(cursor.startTime, cursor.id)
+  }
+
+  const where = clauses.length ? `WHERE ${clauses.join(' AND ')}` : ''
+  return {
+    sql: `SELECT ${HISTORY_COLUMNS} FROM sessions ${where} ${HISTORY_ORDER} LIMIT ?`,
+    args: args.concat(limit)
+  }
+}
+
 /**
- * 获取历史记录列表（带分页）
- * @param {number} page - 当前页码，从1开始
+ * 构建历史总数查询
+ * @param {Object} filters - 筛选条件，同 buildHistoryQuery
+ * @returns {{sql:string,args:Array}} 查询
+ */
+export function buildHistoryCountQuery(filters) {
+  const { clauses, args } = buildHistoryWhere(filters)
+  const where = clauses.length ? `WHERE ${clauses.join(' AND ')}` : ''
+  return { sql: `SELECT COUNT(*) as total FROM sessions ${where}`, args }
+}
+
+function getHistoryTotal(filters) {
+  const query = buildHistoryCountQuery(filters)
+  const key = `${query.sql}|${query.args.join(',')}`
+  if (historyTotalCache[key] !== undefined) return Promise.resolve(historyTotalCache[key])
+  const generation = historyCacheGeneration
+
+  return dbManager.executeSql(query)
+  .then(countResult => {
+    const total = (countResult.rows && countResult.rows[0]) ? countResult.rows[0].total : 0
+    if (generation === historyCacheGeneration) historyTotalCache[key] = total
+    return total
+  })
+}
+
+/**
+ * 获取历史记录列表（游标分页，可按模式/日期/强度筛选）
+ * @param {{startTime:number,id:number}|null} cursor - 上一页返回的 nextCursor，首页传 null
  * @param {number} pageSize - 每页条数
- * @returns {Promise} 包含会话列表和总数的Promise
+ * @param {Object} filters - 筛选条件，见 buildHistoryQuery
+ * @returns {Promise<{total:number,items:Array,nextCursor:Object|null,hasMore:boolean,pageSize:number}>} 分页结果
  */
-export function getHistoryList(page = 1, pageSize = 20) {
-  return new Promise((resolve, reject) => {
+export function getHistoryList(cursor = null, pageSize = 20, filters = {}) {
+  return new Promise((resolve) => {
+    const emptyResult = {
+      total: 0,
+      items: [],
+      nextCursor: null,
+      hasMore: false,
+      pageSize
+    }
+
     try {
       // 确保参数合法
-      if (page < 1) page = 1
       if (pageSize < 1) pageSize = 20
       
-      const offset = (page - 1) * pageSize
-      
-      // 构建SQL语句
-      const countSql = 'SELECT COUNT(*) as total FROM sessions'
-      const dataSql = `SELECT * FROM sessions ORDER BY start_time DESC LIMIT ${pageSize} OFFSET ${offset}`
-      
-      // 先查询总数
-      dbManager.executeSql({
-        sql: countSql
-      })
-      .then(countResult => {
-        const total = (countResult.rows && countResult.rows[0]) ? countResult.rows[0].total : 0
+      // 多取一条用于判断是否还有下一页
+      const query = buildHistoryQuery(filters, cursor, pageSize + 1)
+
+      Promise.all([getHistoryTotal(filters), dbManager.executeSql(query)])
+      .then(([total, dataResult]) => {
+        const rows = dataResult.rows || []
+        const hasMore = rows.length > pageSize
+        const items = hasMore ? rows.slice(0, pageSize) : rows
         
-        // 再查询数据
-        return dbManager.executeSql({
-          sql: dataSql
+        // 格式化数据
+        const formattedItems = items.map(item => {
+          return {
+            id: item.id,
+            mode: item.mode,
+            date: item.start_time,
+            duration: item.duration,
+            calories: item.calories || 0,
+            strokes: item.strokes || 0,
+            avgHeartRate: item.avg_heart_rate || 0,
+            maxHeartRate: item.max_heart_rate || 0,
+            minHeartRate: item.min_heart_rate || 0,
+            maxSpeed: item.max_speed || 0,
+            smashes: item.smashes || 0,
+            forehand: item.forehand || 0,
+            backhand: item.backhand || 0
+          }
         })
-        .then(dataResult => {
-          const items = dataResult.rows || []
-          
-          // 格式化数据
-          const formattedItems = items.map(item => {
-            return {
-              id: item.id,
-              mode: item.mode,
-              date: item.start_time,
-              duration: item.duration,
-              calories: item.calories || 0,
-              strokes: item.strokes || 0,
-              avgHeartRate: item.avg_heart_rate || 0,
-              maxHeartRate: item.max_heart_rate || 0,
-              minHeartRate: item.min_heart_rate || 0,
-              maxSpeed: item.max_speed || 0,
-              smashes: item.smashes || 0,
-              forehand: item.forehand || 0,
-              backhand: item.backhand || 0,
-              heartRateSeries: parseSeries(item.heart_rate_series),
-              speedSeries: parseSeries(item.speed_series),
-              scoreboard: parseScoreboard(item.scoreboard),
-              heartRateWarningEvents: parseWarningEvents(item.heart_rate_warning_events)
-            }
-          })
-          
-          resolve({
-            total,
-            items: formattedItems,
-            page,
-            pageSize,
-            totalPages: Math.ceil(total / pageSize)
-          })
+
+        const last = items[items.length - 1]
+        
+        resolve({
+          total,
+          items: formattedItems,
+          nextCursor: hasMore && last ? { startTime: last.start_time, id: last.id } : null,
+          hasMore,
+          pageSize
         })
       })
       .catch(err => {
         console.error('获取历史记录失败:', err)
         // 返回空结果，而不是拒绝Promise
-        resolve({
-          total: 0,
-          items: [],
-          page,
-          pageSize,
-          totalPages: 0
-        })
+        resolve(emptyResult)
       })
     } catch (e) {
       console.error('获取历史记录出错，返回空结果:', e.message)
       // 返回空结果，而不是拒绝Promise
-      resolve({
-        total: 0,
-        items: [],
-        page,
-        pageSize,
-        totalPages: 0
-      })
+      resolve(emptyResult)
     }
   })
 }
 
+/**
+ * 空统计结果
+ * @returns {Object} 统计结果
+ */
+function emptyStats() {
+  return {
+    totalDuration: 0,
+    totalCalories: 0,
+    totalStrokes: 0,
+    avgHeartRate: 0,
+    heartRateSeries: [],
+    speedSeries: []
+  }
+}
+
 /**
  * 获取指定时间范围内的统计数据
  * @param {number} startTime - 开始时间戳（毫秒）
  * @param {number} endTime - 结束时间戳（毫秒）
- * @returns {Promise} 统计数据Promise
+ * @param {number} maxPoints - 趋势序列点数上限（通常为 chartPointLimit(画布宽度)），超出时按 LTTB 预降采样；缺省不限
  * @returns {Promise<{totalDuration:number,totalCalories:number,totalStrokes:number,avgHeartRate:number,heartRateSeries:Array<{t:number,v:number}>,speedSeries:Array<{t:number,v:number}>}>} 统计结果
- * 说明：心率/拍速序列以会话 start_time 为横轴；心率使用 avg_heart_rate，拍速使用 max_speed；avgHeartRate 为时长加权平均。
+ * 说明：数据来自 session_rollups 汇总行（跨度≤62天按日，否则按月），每个桶一个点；
+ * 心率为桶内时长加权平均，拍速为桶内各会话最高拍速的平均；avgHeartRate 为时长加权平均。
+ * 结果（含降采样后的趋势）按区间与点数上限缓存，会话写入后失效。
  */
-export function getStatsByRange(startTime, endTime) {
-  return new Promise((resolve, reject) => {
+export function getStatsByRange(startTime, endTime, maxPoints = 0) {
+  return new Promise((resolve) => {
     try {
       if (!startTime || !endTime || isNaN(startTime) || isNaN(endTime)) {
-        resolve({
-          totalDuration: 0,
-          totalCalories: 0,
-          totalStrokes: 0,
-          avgHeartRate: 0,
-          heartRateSeries: [],
-          speedSeries: []
-        })
+        resolve(emptyStats())
         return
       }
 
-      const sql = `SELECT * FROM sessions WHERE start_time >= ? AND start_time < ? ORDER BY start_time ASC`
-
-      dbManager.executeSql({
-        sql,
-        args: [startTime, endTime]
-      })
-      .then(data => {
-        const rows = data && data.rows ? data.rows : []
-        if (!rows.length) {
-          resolve({
-            totalDuration: 0,
-            totalCalories: 0,
-            totalStrokes: 0,
-            avgHeartRate: 0,
-            heartRateSeries: [],
-            speedSeries: []
-          })
-          return
-        }
-
-        let totalDuration = 0
-        let totalCalories = 0
-        let totalStrokes = 0
-        let totalHeartWeighted = 0
-
-        const heartRateSeries = []
-        const speedSeries = []
-
-        rows.forEach(item => {
-          const duration = item.duration || 0
-          const calories = item.calories || 0
-          const strokes = item.strokes || 0
-          const avgHeartRate = item.avg_heart_rate || 0
-          const maxSpeed = item.max_speed || 0
-
-          totalDuration += duration
-          totalCalories += calories
-          totalStrokes += strokes
-          totalHeartWeighted += avgHeartRate * duration
-
-          heartRateSeries.push({
-            t: item.start_time,
-            v: avgHeartRate
-          })
-          speedSeries.push({
-            t: item.start_time,
-            v: maxSpeed
+      const cacheKey = `${startTime}-${endTime}-${maxPoints}`
+      if (statsRangeCache[cacheKey]) {
+        resolve(statsRangeCache[cacheKey])
+        return
+      }
+      const generation = historyCacheGeneration
+
+      getRollups(pickRollupPeriod(startTime, endTime), startTime, endTime)
+        .then(rows => {
+          if (!rows.length) {
+            resolve(emptyStats())
+            return
+          }
+
+          let totalDuration = 0
+          let totalCalories = 0
+          let totalStrokes = 0
+          let totalHeartWeighted = 0
+
+          const heartRateSeries = []
+          const speedSeries = []
+
+          rows.forEach(item => {
+            const duration = item.total_duration || 0
+            const heartWeighted = item.heart_rate_weighted || 0
+            const count = item.session_count || 0
+
+            totalDuration += duration
+            totalCalories += item.total_calories || 0
+            totalStrokes += item.total_strokes || 0
+            totalHeartWeighted += heartWeighted
+
+            heartRateSeries.push({
+              t: item.period_start,
+              v: duration ? Math.round(heartWeighted / duration) : 0
+            })
+            speedSeries.push({
+              t: item.period_start,
+              v: count ? Math.round((item.max_speed_sum || 0) / count) : 0
+            })
           })
-        })
-
-        const avgHeartRate = totalDuration ? Math.round(totalHeartWeighted / totalDuration) : 0
 
-        resolve({
-          totalDuration,
-          totalCalories: Math.round(totalCalories),
-          totalStrokes,
-          avgHeartRate,
-          heartRateSeries,
-          speedSeries
+          const avgHeartRate = totalDuration ? Math.round(totalHeartWeighted / totalDuration) : 0
+
+          const stats = {
+            totalDuration,
+            totalCalories: Math.round(totalCalories),
+            totalStrokes,
+            avgHeartRate,
+            heartRateSeries: maxPoints ? lttbPoints(heartRateSeries, maxPoints) : heartRateSeries,
+            speedSeries: maxPoints ? lttbPoints(speedSeries, maxPoints) : speedSeries
+          }
+          if (generation === historyCacheGeneration) statsRangeCache[cacheKey] = stats
+          resolve(stats)
         })
-      })
-      .catch(err => {
-        console.error('获取统计数据失败:', err)
-        resolve({
-          totalDuration: 0,
-          totalCalories: 0,
-          totalStrokes: 0,
-          avgHeartRate: 0,
-          heartRateSeries: [],
-          speedSeries: []
+        .catch(err => {
+          console.error('获取统计数据失败:', err)
+          resolve(emptyStats())
         })
-      })
     } catch (e) {
       console.error('获取统计数据出错:', e.message)
-      resolve({
-        totalDuration: 0,
-        totalCalories: 0,
-        totalStrokes: 0,
-        avgHeartRate: 0,
-        heartRateSeries: [],
-        speedSeries: []
-      })
+      resolve(emptyStats())
     }
   })
 }
@@ -390,12 +499,9 @@ export function getSessionById(sessionId) {
         return
       }
       
-      // 构建SQL语句
-      const sql = 'SELECT * FROM sessions WHERE id = ?'
-      
       // 执行SQL
       dbManager.executeSql({
-        sql,
+        sql: SESSION_BY_ID_SQL,
         args: [sessionId]
       })
       .then(data => {
@@ -423,6 +529,55 @@ export function getSessionById(sessionId) {
   })
 }
 
+/**
+ * 把数据库行转换为归档所需的驼峰字段
+ * @param {Object} row - getSessionById 的返回值
+ * @returns {Object} 会话数据
+ */
+export function toArchiveSession(row) {
+  return {
+    startTime: row.start_time,
+    endTime: row.end_time,
+    duration: row.duration,
+    calories: row.calories,
+    maxSpeed: row.max_speed,
+    avgHeartRate: row.avg_heart_rate,
+    maxHeartRate: row.max_heart_rate,
+    minHeartRate: row.min_heart_rate,
+    strokes: row.strokes,
+    smashes: row.smashes,
+    forehand: row.forehand,
+    backhand: row.backhand,
+    heartRateSeries: row.heartRateSeries,
+    speedSeries: row.speedSeries
+  }
+}
+
+/**
+ * 获取单个会话的汇总字段（不含序列）
+ * @param {number} sessionId - 会话ID
+ * @returns {Promise} 会话数据Promise
+ */
+export function getSessionSummaryById(sessionId) {
+  if (!sessionId || isNaN(sessionId)) {
+    return Promise.reject(new Error('无效的会话ID'))
+  }
+
+  return dbManager.executeSql({
+    sql: SESSION_SUMMARY_BY_ID_SQL,
+    args: [sessionId]
+  })
+  .then(data => {
+    const row = data && data.rows && data.rows[0]
+    if (!row) throw new Error('未找到指定会话')
+    return {
+      ...row,
+      scoreboard: parseScoreboard(row.scoreboard),
+      heartRateWarningEvents: parseWarningEvents(row.heart_rate_warning_events)
+    }
+  })
+}
+
 /**
  * 更新会话数据
  * @param {number} sessionId - 会话ID
@@ -444,6 +599,12 @@ export function updateSession(sessionId, updates) {
       }
 
       const normalizedUpdates = { ...updates }
+      // 未提供的字段不更新（避免把序列等置空）
+      Object.keys(normalizedUpdates).forEach(key => {
+        if (normalizedUpdates[key] === undefined) delete normalizedUpdates[key]
+      })
+      const seriesChanged = ['heartRateSeries', 'speedSeries']
+        .some(key => Object.prototype.hasOwnProperty.call(normalizedUpdates, key))
 
       if (Object.prototype.hasOwnProperty.call(normalizedUpdates, 'heartRateSeries')) {
         normalizedUpdates.heart_rate_series = serializeSeries(normalizedUpdates.heartRateSeries)
@@ -492,12 +653,31 @@ export function updateSession(sessionId, updates) {
       const sql = `UPDATE sessions SET ${fields.join(', ')}, updated_at = ? WHERE id = ?`
       values.splice(values.length - 1, 0, Date.now())
       
-      // 执行SQL
-      dbManager.executeSql({
-        sql,
-        args: values
-      })
+      // 先移出旧值再计入新值，保证汇总与会话一致
+      ensureRollups()
+      .then(() => dbManager.transaction(tx => {
+        tx.afterRollback(invalidateHistoryCaches)
+        return applySessionRollups(tx, sessionId, -1)
+          .then(() => applySessionBests(tx, sessionId, -1))
+          .then(() => tx.executeSql({
+            sql,
+            args: values
+          }))
+          // 序列变化时按新序列重算分布直方图
+          .then(data => (seriesChanged ? rebuildSessionHistograms(tx, sessionId) : Promise.resolve()).then(() => data))
+          .then(data => applySessionRollups(tx, sessionId, 1)
+            .then(() => applySessionBests(tx, sessionId, 1))
+            .then(() => data))
+          .then(data => {
+            if (seriesChanged) {
+              tx.afterCommit(() => getSessionById(sessionId)
+                .then(session => writeSessionArchive(sessionId, toArchiveSession(session))))
+            }
+            return data
+          })
+      }))
       .then(data => {
+        invalidateHistoryCaches()
         resolve(data.rowsAffected || 0)
       })
       .catch(err => {
@@ -525,15 +705,27 @@ export function deleteSession(sessionId) {
         return
       }
       
-      // 构建SQL语句
-      const sql = 'DELETE FROM sessions WHERE id = ?'
-      
-      // 执行SQL
-      dbManager.executeSql({
-        sql,
-        args: [sessionId]
-      })
+      // 删除前先从汇总中移出
+      ensureRollups()
+      .then(() => dbManager.transaction(tx => {
+        tx.afterRollback(invalidateHistoryCaches)
+        return applySessionRollups(tx, sessionId, -1)
+          .then(() => deleteStrokes(tx, sessionId))
+          .then(() => deleteSessionHistograms(tx, sessionId))
+          .then(() => applySessionBests(tx, sessionId, -1))
+          .then(() => tx.executeSql({
+            sql: SESSION_DELETE_SQL,
+            args: [sessionId]
+          }))
+          // 删除的是前几名时从剩余会话补齐
+          .then(data => refillPersonalBests(tx).then(() => data))
+          .then(data => {
+            tx.afterCommit(() => removeSessionArchive(sessionId))
+            return data
+          })
+      }))
       .then(data => {
+        invalidateHistoryCaches()
         resolve(data.rowsAffected || 0)
       })
       .catch(err => {
@@ -581,31 +773,43 @@ export function saveReport(sessionData) {
   return saveSession(sessionData)
 }
 
+// 用户设置存放在键值存储中；旧版本写在 user_settings 表，首次读取时迁入
+const USER_SETTINGS_KEY = 'userSettings'
+
+function readLegacyUserSettings() {
+  return dbManager.executeSql({
+    sql: 'SELECT data FROM user_settings WHERE id = 1'
+  })
+    .then(data => {
+      const row = data && data.rows && data.rows[0] ? data.rows[0] : null
+      if (!row || !row.data) return null
+
+      try {
+        return JSON.parse(row.data)
+      } catch (e) {
+        console.error('解析用户设置失败:', e.message)
+        return null
+      }
+    })
+}
+
 /**
  * 获取用户设置
  * @returns {Promise} 用户设置Promise
  */
 export function getUserSettings() {
   return new Promise((resolve) => {
-    const sql = 'SELECT data FROM user_settings WHERE id = 1'
-
-    dbManager.executeSql({
-      sql
-    })
-      .then(data => {
-        const row = data && data.rows && data.rows[0] ? data.rows[0] : null
-        if (!row || !row.data) {
-          resolve(null)
-          return
-        }
-
-        try {
-          resolve(JSON.parse(row.data))
-        } catch (e) {
-          console.error('解析用户设置失败:', e.message)
-          resolve(null)
-        }
+    storageManager.getItem(USER_SETTINGS_KEY)
+      .then(settings => {
+        if (settings !== undefined) return settings
+
+        return readLegacyUserSettings()
+          .then(legacy => {
+            if (legacy) storageManager.setItem(USER_SETTINGS_KEY, legacy)
+            return legacy
+          })
       })
+      .then(settings => resolve(settings || null))
       .catch(err => {
         console.error('获取用户设置失败:', err)
         resolve(null)
@@ -620,19 +824,14 @@ export function getUserSettings() {
  */
 export function saveUserSettings(settings) {
   return new Promise((resolve, reject) => {
-    const payload = JSON.stringify(settings || {})
-    const now = Date.now()
-    const sql = `
-      INSERT INTO user_settings (id, data, updated_at)
-      VALUES (1, ?, ?)
-      ON CONFLICT(id) DO UPDATE SET data = excluded.data, updated_at = excluded.updated_at
-    `
-
-    dbManager.executeSql({
-      sql,
-      args: [payload, now]
-    })
-      .then(() => resolve(true))
+    storageManager.setItem(USER_SETTINGS_KEY, settings || {})
+      .then(saved => {
+        if (saved) {
+          resolve(true)
+          return
+        }
+        reject(new Error('写入失败'))
+      })
       .catch(err => {
         console.error('保存用户设置失败:', err)
         reject(err)
@@ -647,15 +846,22 @@ export function saveUserSettings(settings) {
 export function clearAllData() {
   return new Promise((resolve, reject) => {
     try {
-      // 构建SQL语句
-      const sql = 'DELETE FROM sessions'
-      
-      // 执行SQL
-      dbManager.executeSql({
-        sql
-      })
+      // 会话及其派生数据（汇总、明细、直方图、个人最佳、成就）与未提交的检查点在一个事务内清空，
+      // 否则下次启动会把检查点恢复进刚清空的数据库
+      dbManager.batch([
+        { sql: 'DELETE FROM session_checkpoints' },
+        { sql: 'DELETE FROM session_rollups' },
+        { sql: 'DELETE FROM session_strokes' },
+        { sql: 'DELETE FROM session_histograms' },
+        { sql: 'DELETE FROM rollup_histograms' },
+        { sql: 'DELETE FROM personal_bests' },
+        { sql: 'DELETE FROM achievements' },
+        { sql: 'DELETE FROM sessions' }
+      ])
       .then(data => {
-        resolve(data.rowsAffected || 0)
+        invalidateHistoryCaches()
+        return Promise.all([clearSessionArchives(), reloadAchievements()])
+          .then(() => resolve(data.rowsAffected || 0))
       })
       .catch(err => {
         console.error('清除数据失败:', err)
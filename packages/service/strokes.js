@@ -0,0 +1,89 @@
+/**
+ * 逐拍明细模块
+ * 会话结束时在入库事务内批量写入 session_strokes，报告页按时间范围读取
+ */
+import dbManager from '../core/utils/database'
+
+// 每条 INSERT 的最大行数（6 个参数/行，低于 SQLite 默认 999 个参数上限）
+const ROWS_PER_INSERT = 150
+// 单次会话明细写入的耗时预算（毫秒），超出时记录告警
+export const STROKE_WRITE_BUDGET = 300
+
+const STROKE_ROW_PLACEHOLDER = '(?, ?, ?, ?, ?, ?)'
+const STROKE_INSERT_PREFIX = 'INSERT OR REPLACE INTO session_strokes (session_id, t, type, speed, peak_acc, rally) VALUES '
+// 满批次的 SQL 只构建一次
+const STROKE_INSERT_FULL_SQL = STROKE_INSERT_PREFIX + new Array(ROWS_PER_INSERT).fill(STROKE_ROW_PLACEHOLDER).join(', ')
+const STROKE_RANGE_SQL = `
+  SELECT t, type, speed, peak_acc, rally FROM session_strokes
+  WHERE session_id = ? AND t >= ? AND t < ?
+  ORDER BY t ASC
+`
+const STROKE_DELETE_SQL = 'DELETE FROM session_strokes WHERE session_id = ?'
+
+/**
+ * 在事务内批量写入会话的挥拍明细
+ * @param {Object} tx - dbManager.transaction 提供的事务上下文
+ * @param {number} sessionId - 会话ID
+ * @param {Array<{t:number,type:number,speed:number,peakAcceleration:number,rally:number}>} strokes - 挥拍明细，type 为 STROKE_FLAG 组合
+ * @returns {Promise}
+ */
+export function insertStrokes(tx, sessionId, strokes) {
+  if (!sessionId || !strokes || !strokes.length) return Promise.resolve()
+
+  const startedAt = Date.now()
+  let chain = Promise.resolve()
+
+  for (let i = 0; i < strokes.length; i += ROWS_PER_INSERT) {
+    const chunk = strokes.slice(i, i + ROWS_PER_INSERT)
+    const args = []
+    chunk.forEach(stroke => {
+      args.push(sessionId, stroke.t, stroke.type, stroke.speed || 0, stroke.peakAcceleration || 0, stroke.rally || 0)
+    })
+    const sql = chunk.length === ROWS_PER_INSERT
+      ? STROKE_INSERT_FULL_SQL
+      : STROKE_INSERT_PREFIX + chunk.map(() => STROKE_ROW_PLACEHOLDER).join(', ')
+    chain = chain.then(() => tx.executeSql({ sql, args }))
+  }
+
+  return chain.then(() => {
+    const elapsed = Date.now() - startedAt
+    if (elapsed > STROKE_WRITE_BUDGET) {
+      console.error(`挥拍明细写入超出预算: ${strokes.length} 条, 耗时 ${elapsed}ms`)
+    }
+  })
+}
+
+/**
+ * 在事务内删除会话的挥拍明细
+ * @param {Object} tx - 事务上下文
+ * @param {number} sessionId - 会话ID
+ * @returns {Promise}
+ */
+export function deleteStrokes(tx, sessionId) {
+  return tx.executeSql({ sql: STROKE_DELETE_SQL, args: [sessionId] })
+}
+
+/**
+ * 按时间范围读取挥拍明细
+ * @param {number} sessionId - 会话ID
+ * @param {number} startTime - 开始时间戳（毫秒，含），默认从头
+ * @param {number} endTime - 结束时间戳（毫秒，不含），默认到尾
+ * @returns {Promise<Array<{t:number,type:number,speed:number,peakAcceleration:number,rally:number}>>} 挥拍明细
+ */
+export function getStrokesInRange(sessionId, startTime = 0, endTime = Number.MAX_SAFE_INTEGER) {
+  return dbManager.executeSql({
+    sql: STROKE_RANGE_SQL,
+    args: [sessionId, startTime, endTime]
+  })
+  .then(data => (data && data.rows ? data.rows : []).map(row => ({
+    t: row.t,
+    type: row.type,
+    speed: row.speed,
+    peakAcceleration: row.peak_acc,
+    rally: row.rally
+  })))
+  .catch(err => {
+    console.error('读取挥拍明细失败:', err)
+    return []
+  })
+}
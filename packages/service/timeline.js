@@ -0,0 +1,199 @@
+/**
+ * 会话时间轴模块（Report 回放）
+ * 心率/拍速序列直接在归档的类型化数组上二分定位，心率预警按时间排序后二分；
+ * 挥拍明细不整场读入，按固定时长分页经主键 (session_id, t) 区间读取，只缓存播放位置附近的几页，
+ * 任意位置的定位为 O(log n)，播放时只取可见窗口
+ */
+import { getStrokesInRange } from './strokes'
+
+// 回放倍速
+export const PLAYBACK_SPEEDS = [1, 4, 16, 64]
+// 可见窗口时长（毫秒），以播放位置为右边缘
+export const TIMELINE_WINDOW_MS = 60 * 1000
+// 挥拍明细分页时长与缓存页数（当前页、上一页与预读的下一页）
+const STROKE_PAGE_MS = 5 * 60 * 1000
+const MAX_STROKE_PAGES = 3
+
+/**
+ * 在升序数组中查找第一个不小于 value 的下标
+ * @param {ArrayLike<number>} sorted - 升序数组（可为类型化数组）
+ * @param {number} length - 有效长度
+ * @param {number} value - 目标值
+ * @returns {number} 下标，全部小于 value 时为 length
+ */
+export function lowerBound(sorted, length, value) {
+  let low = 0
+  let high = length
+  while (low < high) {
+    const mid = (low + high) >>> 1
+    if (sorted[mid] < value) {
+      low = mid + 1
+    } else {
+      high = mid
+    }
+  }
+  return low
+}
+
+/**
+ * 列式序列在 [startTime, endTime) 内的下标范围
+ * @param {{baseTime:number,t:ArrayLike<number>,length:number}} series - 列式序列（t 为相对 baseTime 的偏移）
+ * @param {number} startTime - 开始时间戳（毫秒，含）
+ * @param {number} endTime - 结束时间戳（毫秒，不含）
+ * @returns {{from:number,to:number}} 下标范围
+ */
+export function seriesRange(series, startTime, endTime) {
+  if (!series || !series.length) return { from: 0, to: 0 }
+  return {
+    from: lowerBound(series.t, series.length, startTime - series.baseTime),
+    to: lowerBound(series.t, series.length, endTime - series.baseTime)
+  }
+}
+
+/**
+ * 列式序列在某一时刻的取值（不晚于该时刻的最后一个点）
+ * @param {Object} series - 列式序列
+ * @param {number} time - 时间戳（毫秒）
+ * @returns {number|null} 数值，该时刻之前没有点时为 null
+ */
+export function seriesValueAt(series, time) {
+  if (!series || !series.length) return null
+  const index = lowerBound(series.t, series.length, time - series.baseTime + 1) - 1
+  return index >= 0 ? series.v[index] : null
+}
+
+/**
+ * 创建会话时间轴
+ * @param {{id:number,startTime:number,endTime:number,heartRate:Object,speed:Object,heartRateWarningEvents:Array}} session -
+ *   heartRate / speed 为列式序列；id 为空（未入库或示例数据）时不读取挥拍明细
+ * @returns {Object} 时间轴实例：frameAt / prefetch / getStats
+ */
+export function createTimeline(session) {
+  const heartRate = session.heartRate
+  const speed = session.speed
+  const warnings = (session.heartRateWarningEvents || [])
+    .filter(event => event && event.t)
+    .sort((a, b) => a.t - b.t)
+  const warningTimes = new Float64Array(warnings.length)
+  warnings.forEach((event, i) => {
+    warningTimes[i] = event.t
+  })
+
+  const seriesEnd = series => (series && series.length ? series.baseTime + series.t[series.length - 1] : 0)
+  const startTime = session.startTime || (heartRate && heartRate.baseTime) || 0
+  const endTime = Math.max(session.endTime || 0, seriesEnd(heartRate), seriesEnd(speed), startTime)
+
+  // 页号 -> { t: Float64Array, rows, promise }；页号按 startTime 起每 STROKE_PAGE_MS 划分
+  const strokePages = new Map()
+  const stats = { frames: 0, strokeQueries: 0, strokeRowsLoaded: 0 }
+
+  function pageOf(time) {
+    return Math.max(0, Math.floor((time - startTime) / STROKE_PAGE_MS))
+  }
+
+  function evictPages(center) {
+    if (strokePages.size <= MAX_STROKE_PAGES) return
+    // 淘汰离播放位置最远的页
+    const sorted = Array.from(strokePages.keys()).sort((a, b) => Math.abs(b - center) - Math.abs(a - center))
+    for (let i = 0; strokePages.size > MAX_STROKE_PAGES; i++) {
+      strokePages.delete(sorted[i])
+    }
+  }
+
+  function loadStrokePage(page) {
+    const cached = strokePages.get(page)
+    if (cached) return cached.promise
+
+    const entry = { t: new Float64Array(0), rows: [], promise: null }
+    const pageStart = startTime + page * STROKE_PAGE_MS
+    if (!session.id || pageStart > endTime) {
+      entry.promise = Promise.resolve(entry)
+    } else {
+      stats.strokeQueries++
+      entry.promise = getStrokesInRange(session.id, pageStart, pageStart + STROKE_PAGE_MS)
+        .then(rows => {
+          entry.rows = rows
+          entry.t = new Float64Array(rows.length)
+          rows.forEach((row, i) => {
+            entry.t[i] = row.t
+          })
+          stats.strokeRowsLoaded += rows.length
+          return entry
+        })
+    }
+    strokePages.set(page, entry)
+    return entry.promise
+  }
+
+  function strokesInWindow(pages, windowStart, windowEnd) {
+    const result = []
+    pages.forEach(entry => {
+      const from = lowerBound(entry.t, entry.t.length, windowStart)
+      const to = lowerBound(entry.t, entry.t.length, windowEnd)
+      for (let i = from; i < to; i++) result.push(entry.rows[i])
+    })
+    return result
+  }
+
+  return {
+    startTime,
+    endTime,
+    duration: endTime - startTime,
+
+    /**
+     * 取播放位置的一帧：位置处的心率/拍速、最近一次预警，以及可见窗口内的序列下标范围、预警与挥拍
+     * @param {number} time - 播放位置（时间戳，毫秒），超出会话时截断
+     * @param {number} windowMs - 窗口时长，默认 TIMELINE_WINDOW_MS
+     * @returns {Promise<Object>} 帧
+     */
+    frameAt(time, windowMs = TIMELINE_WINDOW_MS) {
+      const position = Math.min(endTime, Math.max(startTime, time))
+      const windowStart = position - windowMs
+      // 窗口含播放位置本身
+      const windowEnd = position + 1
+      const firstPage = pageOf(windowStart)
+      const lastPage = pageOf(position)
+      const loads = []
+      for (let page = firstPage; page <= lastPage; page++) loads.push(loadStrokePage(page))
+      evictPages(lastPage)
+      stats.frames++
+
+      const warningIndex = lowerBound(warningTimes, warningTimes.length, windowEnd) - 1
+      const warningFrom = lowerBound(warningTimes, warningTimes.length, windowStart)
+
+      return Promise.all(loads).then(pages => ({
+        time: position,
+        windowStart,
+        windowEnd,
+        heartRate: seriesValueAt(heartRate, position),
+        speed: seriesValueAt(speed, position),
+        heartRateRange: seriesRange(heartRate, windowStart, windowEnd),
+        speedRange: seriesRange(speed, windowStart, windowEnd),
+        warning: warningIndex >= 0 ? warnings[warningIndex] : null,
+        warnings: warnings.slice(warningFrom, warningIndex + 1),
+        strokes: strokesInWindow(pages, windowStart, windowEnd)
+      }))
+    },
+
+    /**
+     * 预读播放位置之后的一页挥拍明细，播放跨页时不等待查询
+     * @param {number} time - 播放位置（时间戳，毫秒）
+     * @returns {Promise}
+     */
+    prefetch(time) {
+      const next = pageOf(time) + 1
+      if (startTime + next * STROKE_PAGE_MS > endTime) return Promise.resolve()
+      const promise = loadStrokePage(next)
+      evictPages(pageOf(time))
+      return promise
+    },
+
+    /**
+     * 时间轴统计：帧数、挥拍分页查询次数与累计读取行数
+     * @returns {{frames:number,strokeQueries:number,strokeRowsLoaded:number,cachedPages:number}}
+     */
+    getStats() {
+      return { ...stats, cachedPages: strokePages.size }
+    }
+  }
+}
@@ -0,0 +1,437 @@
+/**
+ * 图表引擎（FeatherChart 与 Report / History 共用）
+ * 支持 折线 / 柱状 / 饼图 / 占比 四种类型；几何（像素坐标、矩形、扇区角度）写入实例持有的 Float32Array，
+ * 只在数据或尺寸变化时重算，且容量足够时原地覆盖；重复绘制只遍历缓冲发出画布调用，不分配对象；
+ * 折线在固定横轴区间内追加点时只计算新点的坐标
+ */
+import { columnarFromPoints, m4Columnar, seriesExtent } from '../core/utils/downsample'
+
+export const CHART_TYPE = {
+  LINE: 'line',
+  BAR: 'bar',
+  PIE: 'pie',
+  RATIO: 'ratio'
+}
+
+const DEFAULT_COLORS = ['#33C9AB', '#2B7A9A', '#FF5733', '#4CAF50']
+const AXIS_COLOR = '#CCCCCC'
+const EMPTY_COLOR = '#DDDDDD'
+const PIE_BACKGROUND = '#F2F2F2'
+const LABEL_COLOR = '#666666'
+const LABEL_FONT = '12px sans-serif'
+// 追加点时序列缓冲的最小容量
+const MIN_CAPACITY = 64
+
+/**
+ * 把折线数据统一为列式序列：列式序列原样使用，[{t, v}] 按时间，[{value}] 按下标
+ * @param {Object|Array} data - 序列
+ * @returns {{baseTime:number,t:ArrayLike<number>,v:ArrayLike<number>,length:number}} 列式序列
+ */
+function toSeries(data) {
+  if (data && data.t && data.v) return data
+  const list = Array.isArray(data) ? data : []
+  if (list.length && list[0].t === undefined) {
+    return columnarFromPoints(list.map((item, index) => ({ t: index, v: item.value })))
+  }
+  return columnarFromPoints(list)
+}
+
+/**
+ * 可追加的列式序列：容量按倍数增长，追加摊还 O(1)
+ * @param {Object} series - 初始列式序列
+ * @returns {Object} 可追加序列
+ */
+function toGrowableSeries(series) {
+  const capacity = Math.max(MIN_CAPACITY, series.length * 2)
+  const t = new Float64Array(capacity)
+  const v = new Float32Array(capacity)
+  for (let i = 0; i < series.length; i++) {
+    t[i] = series.t[i]
+    v[i] = series.v[i]
+  }
+  return { baseTime: series.baseTime, t, v, length: series.length, growable: true }
+}
+
+function pushPoint(series, time, value, stats) {
+  if (series.length === series.t.length) {
+    stats.bufferAllocations++
+    const t = new Float64Array(series.t.length * 2)
+    const v = new Float32Array(series.v.length * 2)
+    t.set(series.t)
+    v.set(series.v)
+    series.t = t
+    series.v = v
+  }
+  if (!series.length) series.baseTime = time
+  series.t[series.length] = time - series.baseTime
+  series.v[series.length] = value
+  series.length++
+}
+
+function sliceValue(item) {
+  return typeof item === 'number' ? item : (item && Number(item.value)) || 0
+}
+
+/**
+ * 创建图表实例
+ * @param {Object} ctx - canvas 2d 上下文
+ * @param {{type:string,width:number,height:number,padding?:number,colors?:Array<string>,axis?:boolean,xDomain?:Array<number>}} options -
+ *   xDomain 固定折线横轴区间 [开始, 结束]（绝对时间），区间内追加点不触发重算
+ * @returns {Object} 图表实例：setData / append / resize / draw / getStats
+ */
+export function createFeatherChart(ctx, options) {
+  const type = options.type || CHART_TYPE.LINE
+  const colors = options.colors || DEFAULT_COLORS
+  const showAxis = options.axis !== undefined ? options.axis : type === CHART_TYPE.LINE || type === CHART_TYPE.BAR
+  let width = options.width
+  let height = options.height
+  const padding = options.padding !== undefined ? options.padding : 8
+
+  // 折线：[{ key, color, min, max, series, extent, line }]；柱状/饼图：[{ label, value, color }]
+  let items = []
+  let dirty = true
+  const stats = { geometryBuilds: 0, incrementalAppends: 0, draws: 0, bufferAllocations: 0 }
+
+  // 几何缓冲：实例内复用，容量不足时才重新分配
+  const geometry = {
+    // 折线共用的绘图区与横轴范围；各序列的纵轴范围写入 item.layout
+    layout: { left: 0, top: 0, width: 0, height: 0, tMin: 0, tMax: 0, vMin: 0, vMax: 0 },
+    // 柱状：每柱 [x, y, w, h]；饼图：每扇区 [起始角, 结束角]
+    shapes: new Float32Array(0),
+    labelY: 0,
+    total: 0,
+    centerX: 0,
+    centerY: 0,
+    radius: 0
+  }
+
+  function ensureShapes(size) {
+    if (geometry.shapes.length < size) {
+      geometry.shapes = new Float32Array(size)
+      stats.bufferAllocations++
+    }
+    return geometry.shapes
+  }
+
+  function buildLineGeometry() {
+    const layout = geometry.layout
+    layout.left = padding
+    layout.top = padding
+    layout.width = width - padding * 2
+    layout.height = height - padding * 2
+    layout.tMin = Infinity
+    layout.tMax = -Infinity
+    for (let i = 0; i < items.length; i++) {
+      if (items[i].extent.tMin < layout.tMin) layout.tMin = items[i].extent.tMin
+      if (items[i].extent.tMax > layout.tMax) layout.tMax = items[i].extent.tMax
+    }
+    if (options.xDomain) {
+      layout.tMin = options.xDomain[0]
+      layout.tMax = options.xDomain[1]
+    }
+
+    for (let i = 0; i < items.length; i++) {
+      const item = items[i]
+      const itemLayout = item.layout
+      itemLayout.left = layout.left
+      itemLayout.top = layout.top
+      itemLayout.width = layout.width
+      itemLayout.height = layout.height
+      itemLayout.tMin = layout.tMin
+      itemLayout.tMax = layout.tMax
+      itemLayout.vMin = item.min !== undefined ? item.min : item.extent.vMin
+      itemLayout.vMax = item.max !== undefined ? item.max : item.extent.vMax
+
+      const previous = item.line.xy
+      m4Columnar(item.series, itemLayout, item.line)
+      if (item.line.xy !== previous) stats.bufferAllocations++
+    }
+  }
+
+  function buildBarGeometry() {
+    let hasLabel = false
+    let maxValue = 0
+    for (let i = 0; i < items.length; i++) {
+      if (items[i].label) hasLabel = true
+      if (items[i].value > maxValue) maxValue = items[i].value
+    }
+
+    const areaWidth = width - padding * 2
+    const areaHeight = height - padding * 2
+    const usable = areaHeight - (hasLabel ? 14 : 0)
+    const slot = items.length ? areaWidth / items.length : 0
+    const barWidth = slot * 0.6
+    const rects = ensureShapes(items.length * 4)
+
+    for (let i = 0; i < items.length; i++) {
+      const barHeight = Math.max(0, items[i].value) / (maxValue || 1) * usable
+      rects[i * 4] = padding + slot * i + (slot - barWidth) / 2
+      rects[i * 4 + 1] = padding + usable - barHeight
+      rects[i * 4 + 2] = barWidth
+      rects[i * 4 + 3] = barHeight
+    }
+    geometry.labelY = hasLabel ? padding + areaHeight : 0
+  }
+
+  function buildPieGeometry() {
+    let total = 0
+    for (let i = 0; i < items.length; i++) total += Math.max(0, items[i].value)
+
+    const angles = ensureShapes(items.length * 2)
+    let angle = -Math.PI / 2
+    for (let i = 0; i < items.length; i++) {
+      angles[i * 2] = angle
+      angle += total > 0 ? Math.max(0, items[i].value) / total * Math.PI * 2 : 0
+      angles[i * 2 + 1] = angle
+    }
+
+    geometry.total = total
+    geometry.centerX = width / 2
+    geometry.centerY = height / 2
+    geometry.radius = Math.max(0, Math.min(width, height) / 2 - 6)
+  }
+
+  function buildGeometry() {
+    stats.geometryBuilds++
+    if (type === CHART_TYPE.LINE) {
+      buildLineGeometry()
+    } else if (type === CHART_TYPE.BAR) {
+      buildBarGeometry()
+    } else {
+      buildPieGeometry()
+    }
+  }
+
+  function drawAxis() {
+    ctx.beginPath()
+    ctx.strokeStyle = AXIS_COLOR
+    ctx.lineWidth = 1
+    ctx.moveTo(padding, padding)
+    ctx.lineTo(padding, height - padding)
+    ctx.lineTo(width - padding, height - padding)
+    ctx.stroke()
+  }
+
+  function drawEmptyFrame() {
+    ctx.strokeStyle = EMPTY_COLOR
+    ctx.lineWidth = 1
+    ctx.strokeRect(4, 4, width - 8, height - 8)
+  }
+
+  function drawLine() {
+    let drawable = false
+    for (let i = 0; i < items.length; i++) {
+      if (items[i].line.count) drawable = true
+    }
+    if (!drawable) {
+      drawEmptyFrame()
+      return
+    }
+    if (showAxis) drawAxis()
+
+    for (let k = 0; k < items.length; k++) {
+      const xy = items[k].line.xy
+      const count = items[k].line.count
+      if (!count) continue
+      ctx.beginPath()
+      ctx.moveTo(xy[0], xy[1])
+      for (let i = 1; i < count; i++) {
+        ctx.lineTo(xy[i * 2], xy[i * 2 + 1])
+      }
+      ctx.strokeStyle = items[k].color
+      ctx.lineWidth = 2
+      ctx.stroke()
+    }
+  }
+
+  function drawBar() {
+    if (!items.length) {
+      drawEmptyFrame()
+      return
+    }
+    if (showAxis) drawAxis()
+
+    const rects = geometry.shapes
+    for (let i = 0; i < items.length; i++) {
+      ctx.fillStyle = items[i].color
+      ctx.fillRect(rects[i * 4], rects[i * 4 + 1], rects[i * 4 + 2], rects[i * 4 + 3])
+    }
+
+    if (geometry.labelY) {
+      ctx.fillStyle = LABEL_COLOR
+      ctx.font = LABEL_FONT
+      ctx.textAlign = 'center'
+      for (let i = 0; i < items.length; i++) {
+        if (items[i].label) ctx.fillText(items[i].label, rects[i * 4] + rects[i * 4 + 2] / 2, geometry.labelY)
+      }
+    }
+  }
+
+  function drawPie() {
+    const total = geometry.total
+    const angles = geometry.shapes
+    const centerX = geometry.centerX
+    const centerY = geometry.centerY
+    const radius = geometry.radius
+
+    ctx.beginPath()
+    ctx.fillStyle = PIE_BACKGROUND
+    ctx.arc(centerX, centerY, radius, 0, Math.PI * 2)
+    ctx.fill()
+
+    if (total <= 0) {
+      ctx.beginPath()
+      ctx.strokeStyle = EMPTY_COLOR
+      ctx.lineWidth = 6
+      ctx.arc(centerX, centerY, radius, 0, Math.PI * 2)
+      ctx.stroke()
+      return
+    }
+
+    for (let i = 0; i < items.length; i++) {
+      if (angles[i * 2 + 1] <= angles[i * 2]) continue
+      ctx.beginPath()
+      ctx.moveTo(centerX, centerY)
+      ctx.fillStyle = items[i].color
+      ctx.arc(centerX, centerY, radius, angles[i * 2], angles[i * 2 + 1])
+      ctx.fill()
+    }
+  }
+
+  /**
+   * 追加一个点：固定横轴区间内、数值不超出当前纵轴范围且落在新的像素列时，只计算这一个点
+   */
+  function appendLinePoint(item, time, value) {
+    pushPoint(item.series, time, value, stats)
+    const extent = item.extent
+    const expands = time < extent.tMin || time > extent.tMax || value < extent.vMin || value > extent.vMax
+    if (time < extent.tMin) extent.tMin = time
+    if (time > extent.tMax) extent.tMax = time
+    if (value < extent.vMin) extent.vMin = value
+    if (value > extent.vMax) extent.vMax = value
+
+    if (dirty || !options.xDomain) {
+      dirty = true
+      return
+    }
+
+    const layout = item.layout
+    const vMin = layout.vMin
+    const vMax = layout.vMax
+    const line = item.line
+    const x = layout.left + (time - layout.tMin) * layout.width / (layout.tMax - layout.tMin || 1)
+    const lastX = line.count ? line.xy[(line.count - 1) * 2] : -Infinity
+    const fixedRange = item.min !== undefined && item.max !== undefined
+    const inRange = fixedRange ? value >= vMin && value <= vMax : !expands
+
+    if (time > layout.tMax || !inRange || Math.floor(x) <= Math.floor(lastX) || !line.count) {
+      dirty = true
+      return
+    }
+
+    if (line.xy.length < (line.count + 1) * 2) {
+      const xy = new Float32Array(Math.max(MIN_CAPACITY, line.xy.length * 2))
+      xy.set(line.xy)
+      line.xy = xy
+      stats.bufferAllocations++
+    }
+    line.xy[line.count * 2] = x
+    line.xy[line.count * 2 + 1] = layout.top + layout.height - (value - vMin) * layout.height / (vMax - vMin || 1)
+    line.count++
+    stats.incrementalAppends++
+  }
+
+  return {
+    /**
+     * 设置数据，下一次 draw 时重算几何
+     * @param {Object|Array} data - 折线：{series:[{key,color,data,min?,max?}]} 或 [{value}] / [{t,v}]；
+     *   柱状/饼图：[{label,value,color?}]；占比：[主值, 次值]
+     */
+    setData(data) {
+      if (type === CHART_TYPE.LINE) {
+        const list = data && Array.isArray(data.series) ? data.series : [{ key: 'default', data }]
+        const previous = items
+        items = list.map((entry, index) => {
+          const series = toSeries(entry.data)
+          const key = entry.key || String(index)
+          // 同 key 的序列沿用上一份坐标缓冲，换数据后重算也不重新分配
+          const reused = previous.find(item => item.key === key && item.line)
+          return {
+            key,
+            color: entry.color || colors[index % colors.length],
+            min: entry.min,
+            max: entry.max,
+            series,
+            extent: seriesExtent(series),
+            layout: reused ? reused.layout : { left: 0, top: 0, width: 0, height: 0, tMin: 0, tMax: 0, vMin: 0, vMax: 0 },
+            line: reused ? reused.line : { xy: new Float32Array(0), count: 0 }
+          }
+        })
+      } else {
+        items = (Array.isArray(data) ? data : []).map((entry, index) => ({
+          label: entry && entry.label ? entry.label : '',
+          value: sliceValue(entry),
+          color: (entry && entry.color) || colors[index % colors.length]
+        }))
+      }
+      dirty = true
+    },
+
+    /**
+     * 向折线序列追加点（按时间递增）
+     * @param {string} key - 序列 key
+     * @param {Array<{t:number,v:number}>} points - 新点
+     */
+    append(key, points) {
+      const item = items.find(entry => entry.key === key)
+      if (!item || !Array.isArray(points)) return
+      if (!item.series.growable) {
+        item.series = toGrowableSeries(item.series)
+        stats.bufferAllocations++
+      }
+      for (let i = 0; i < points.length; i++) {
+        appendLinePoint(item, points[i].t, Number(points[i].v) || 0)
+      }
+    },
+
+    /**
+     * 画布尺寸变化
+     * @param {number} nextWidth - 宽度
+     * @param {number} nextHeight - 高度
+     */
+    resize(nextWidth, nextHeight) {
+      if (nextWidth === width && nextHeight === height) return
+      width = nextWidth
+      height = nextHeight
+      dirty = true
+    },
+
+    /**
+     * 绘制：几何过期时先重算，之后只遍历缓存
+     */
+    draw() {
+      if (dirty) {
+        buildGeometry()
+        dirty = false
+      }
+      stats.draws++
+      ctx.clearRect(0, 0, width, height)
+
+      if (type === CHART_TYPE.LINE) {
+        drawLine()
+      } else if (type === CHART_TYPE.BAR) {
+        drawBar()
+      } else {
+        drawPie()
+      }
+    },
+
+    /**
+     * 几何重算、增量追加、绘制与缓冲分配次数（稳定后重绘与同规模重算的 bufferAllocations 不再增长）
+     * @returns {{geometryBuilds:number,incrementalAppends:number,draws:number,bufferAllocations:number}}
+     */
+    getStats() {
+      return { ...stats }
+    }
+  }
+}
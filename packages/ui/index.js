@@ -3,6 +3,11 @@
  * 提供公共UI组件
  */
 
+// 图表引擎（FeatherChart 与页面共用）
+export * from './chartEngine'
+// 回放时间轴视图（Report）
+export * from './timelineView'
+
 // 导出所有组件
 export * from './components/FeatherCard'
 export * from './components/FeatherButton'
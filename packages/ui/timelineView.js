@@ -0,0 +1,148 @@
+/**
+ * 回放时间轴视图（Report 页）
+ * 只绘制时间轴帧的可见窗口：心率/拍速取窗口下标范围内的子视图按像素列 M4 降采样，
+ * 预警画竖线，挥拍画底部刻度（杀球更高），播放位置固定在右边缘；坐标缓冲在实例内复用
+ */
+import { m4Columnar, seriesExtent } from '../core/utils/downsample'
+import { STROKE_FLAG } from '../motion/strokeDetection'
+
+const HEART_RATE_COLOR = '#E74C3C'
+const SPEED_COLOR = '#3498DB'
+const AXIS_COLOR = '#CCCCCC'
+const PLAYHEAD_COLOR = '#333333'
+const STROKE_COLOR = '#33C9AB'
+const SMASH_COLOR = '#F4A642'
+const WARNING_COLORS = { high: '#E74C3C', low: '#4285F4', normal: '#4CAF50' }
+// 底部挥拍刻度高度（像素）
+const STROKE_TICK = 6
+const SMASH_TICK = 12
+
+/**
+ * 创建时间轴视图
+ * @param {Object} ctx - canvas 2d 上下文
+ * @param {{width:number,height:number,padding?:number,heartRate:Object,speed:Object}} options - 尺寸与整场列式序列（纵轴范围按整场固定，播放时不跳动）
+ * @returns {Object} 视图实例：resize / draw
+ */
+export function createTimelineView(ctx, options) {
+  let width = options.width
+  let height = options.height
+  const padding = options.padding !== undefined ? options.padding : 8
+
+  function lineState(series, color) {
+    const extent = seriesExtent(series)
+    return {
+      series,
+      color,
+      vMin: extent.vMin,
+      vMax: extent.vMax,
+      window: { baseTime: series ? series.baseTime : 0, t: null, v: null, length: 0 },
+      layout: { left: 0, top: 0, width: 0, height: 0, tMin: 0, tMax: 0, vMin: extent.vMin, vMax: extent.vMax },
+      line: { xy: new Float32Array(0), count: 0 }
+    }
+  }
+
+  const lines = [lineState(options.heartRate, HEART_RATE_COLOR), lineState(options.speed, SPEED_COLOR)]
+
+  function drawLine(state, range, windowStart, windowEnd) {
+    const series = state.series
+    if (!series || range.to - range.from < 2) return
+
+    // 窗口前一点参与绘制，曲线从左边缘连起
+    const from = Math.max(0, range.from - 1)
+    state.window.t = series.t.subarray(from, range.to)
+    state.window.v = series.v.subarray(from, range.to)
+    state.window.length = range.to - from
+
+    const layout = state.layout
+    layout.left = padding
+    layout.top = padding
+    layout.width = width - padding * 2
+    layout.height = height - padding * 2 - SMASH_TICK
+    layout.tMin = windowStart
+    layout.tMax = windowEnd
+
+    const line = m4Columnar(state.window, layout, state.line)
+    const xy = line.xy
+    ctx.beginPath()
+    ctx.moveTo(Math.max(padding, xy[0]), xy[1])
+    for (let i = 1; i < line.count; i++) {
+      ctx.lineTo(Math.max(padding, xy[i * 2]), xy[i * 2 + 1])
+    }
+    ctx.strokeStyle = state.color
+    ctx.lineWidth = 2
+    ctx.stroke()
+  }
+
+  return {
+    /**
+     * 画布尺寸变化
+     * @param {number} nextWidth - 宽度
+     * @param {number} nextHeight - 高度
+     */
+    resize(nextWidth, nextHeight) {
+      width = nextWidth
+      height = nextHeight
+    },
+
+    /**
+     * 绘制一帧
+     * @param {Object} frame - createTimeline().frameAt 返回的帧
+     */
+    draw(frame) {
+      const windowStart = frame.windowStart
+      const windowEnd = frame.windowEnd
+      const plotWidth = width - padding * 2
+      const bottom = height - padding
+      const xOf = time => padding + (time - windowStart) * plotWidth / (windowEnd - windowStart || 1)
+
+      ctx.clearRect(0, 0, width, height)
+      ctx.beginPath()
+      ctx.strokeStyle = AXIS_COLOR
+      ctx.lineWidth = 1
+      ctx.moveTo(padding, bottom)
+      ctx.lineTo(width - padding, bottom)
+      ctx.stroke()
+
+      drawLine(lines[0], frame.heartRateRange, windowStart, windowEnd)
+      drawLine(lines[1], frame.speedRange, windowStart, windowEnd)
+
+      for (let i = 0; i < frame.warnings.length; i++) {
+        const warning = frame.warnings[i]
+        const x = xOf(warning.t)
+        ctx.beginPath()
+        ctx.strokeStyle = WARNING_COLORS[warning.type] || WARNING_COLORS.normal
+        ctx.lineWidth = 1
+        ctx.moveTo(x, padding)
+        ctx.lineTo(x, bottom)
+        ctx.stroke()
+      }
+
+      // 挥拍刻度按类型分两批，各一次 stroke
+      for (let pass = 0; pass < 2; pass++) {
+        const smash = pass === 1
+        let drawn = 0
+        ctx.beginPath()
+        for (let i = 0; i < frame.strokes.length; i++) {
+          const stroke = frame.strokes[i]
+          if (Boolean(stroke.type & STROKE_FLAG.SMASH) !== smash) continue
+          const x = xOf(stroke.t)
+          ctx.moveTo(x, bottom)
+          ctx.lineTo(x, bottom - (smash ? SMASH_TICK : STROKE_TICK))
+          drawn++
+        }
+        if (drawn) {
+          ctx.strokeStyle = smash ? SMASH_COLOR : STROKE_COLOR
+          ctx.lineWidth = 2
+          ctx.stroke()
+        }
+      }
+
+      ctx.beginPath()
+      ctx.strokeStyle = PLAYHEAD_COLOR
+      ctx.lineWidth = 1
+      ctx.moveTo(width - padding, padding)
+      ctx.lineTo(width - padding, bottom)
+      ctx.stroke()
+    }
+  }
+}
@@ -0,0 +1,7 @@
+/**
+ * 轻羽飞扬 - Watchface 表盘
+ * 显示时间，运动中叠加实时快照（packages/motion/liveStats）中的时长、心率与挥拍数
+ * 快照只在应用进程内共享：组件需嵌入应用页面使用，注册为系统表盘后读不到数据
+ */
+
+export * from './LiveWatchface'
@@ -6,6 +6,7 @@ type HeartRate = typeof import('@blueos.app.health.heartrate');
 type Workout = typeof import('@blueos.app.health.workout');
 type Notification = typeof import('@blueos.app.notification');
 type Database = typeof import('@blueos.app.storage.database');
+type File = typeof import('@blueos.storage.file');
 
 /**
  * 全局类型定义
@@ -78,8 +79,10 @@ interface Window {
   workout: any;
   notification: any;
   database: any;
+  file: any;
   dbManager: DatabaseManager;
   dbInitPromise: Promise<any>;
+  storageInitPromise: Promise<any>;
   CONSTANTS: Constants;
   storage: StorageAPI;
   onerror: (error: Error) => boolean;
@@ -93,8 +96,10 @@ declare global {
   const workout: Window['workout'];
   const notification: Window['notification'];
   const database: Window['database'];
+  const file: Window['file'];
   const dbManager: Window['dbManager'];
   const dbInitPromise: Window['dbInitPromise'];
+  const storageInitPromise: Window['storageInitPromise'];
   const CONSTANTS: Window['CONSTANTS'];
   const storage: Window['storage'];
   const onerror: Window['onerror'];
@@ -108,8 +113,10 @@ declare global {
       workout: Window['workout'];
       notification: Window['notification'];
       database: Window['database'];
+      file: Window['file'];
       dbManager: Window['dbManager'];
       dbInitPromise: Window['dbInitPromise'];
+      storageInitPromise: Window['storageInitPromise'];
       CONSTANTS: Window['CONSTANTS'];
       storage: Window['storage'];
       onerror: Window['onerror'];
@@ -44,6 +44,79 @@ if (!global.storage) {
   };
 }
 
+// 文件API不可用时（预览/模拟器）使用内存实现，接口与 @blueos.storage.file 一致
+if (!global.file) {
+  const memoryFiles = {};
+  const done = (options, method, value) => {
+    if (typeof options[method] === 'function') {
+      options[method](value);
+    }
+    if (typeof options.complete === 'function') {
+      options.complete();
+    }
+  };
+
+  global.file = {
+    writeArrayBuffer(options) {
+      const current = memoryFiles[options.uri] || new Uint8Array(0);
+      const position = options.append ? current.length : (options.position || 0);
+      const size = Math.max(current.length, position + options.buffer.length);
+      const next = new Uint8Array(size);
+      next.set(current);
+      next.set(options.buffer, position);
+      memoryFiles[options.uri] = next;
+      done(options, 'success');
+    },
+    readArrayBuffer(options) {
+      const current = memoryFiles[options.uri];
+      if (!current) {
+        if (typeof options.fail === 'function') options.fail('file not found', 301);
+        return;
+      }
+      const position = options.position || 0;
+      const end = options.length === undefined ? current.length : position + options.length;
+      done(options, 'success', { buffer: current.slice(position, end) });
+    },
+    get(options) {
+      const current = memoryFiles[options.uri];
+      if (!current) {
+        if (typeof options.fail === 'function') options.fail('file not found', 301);
+        return;
+      }
+      done(options, 'success', { uri: options.uri, length: current.length, lastModifiedTime: Date.now(), type: 'file' });
+    },
+    list(options) {
+      const fileList = Object.keys(memoryFiles)
+        .filter(uri => uri.indexOf(options.uri) === 0)
+        .map(uri => ({ uri, length: memoryFiles[uri].length, lastModifiedTime: Date.now() }));
+      done(options, 'success', { fileList });
+    },
+    delete(options) {
+      delete memoryFiles[options.uri];
+      done(options, 'success');
+    },
+    move(options) {
+      const current = memoryFiles[options.srcUri];
+      if (!current) {
+        if (typeof options.fail === 'function') options.fail('file not found', 301);
+        return;
+      }
+      memoryFiles[options.dstUri] = current;
+      delete memoryFiles[options.srcUri];
+      done(options, 'success', options.dstUri);
+    },
+    mkdir(options) {
+      done(options, 'success');
+    },
+    rmdir(options) {
+      Object.keys(memoryFiles)
+        .filter(uri => uri.indexOf(options.uri) === 0)
+        .forEach(uri => delete memoryFiles[uri]);
+      done(options, 'success');
+    }
+  };
+}
+
 // 全局常量
 global.CONSTANTS = {
   // 运动模式